@@ -0,0 +1,125 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include "Board.h"
+#include "Move.h"
+#include "Network.h"
+#include "Piece.h"
+
+/// <summary>
+/// The network evaluator's first layer for each position along the search path, indexed by ply. The root's
+/// is built from its pieces, and each one after that from its parent's, subtracting the weights of whatever
+/// a move takes off a square and adding those of whatever it puts there. Boards carry no accumulator, so
+/// copying them stays cheap, and nothing here is touched unless the network is active.
+/// Not thread safe - each search thread is expected to use its own
+/// </summary>
+class AccumulatorStack
+{
+private:
+    // Deeper than any search goes, so the stack won't usually grow
+    inline static const unsigned short INITIAL_PLIES = 128;
+
+    std::vector<Network::Accumulator> accumulators;
+
+    inline static void updateSquare( Network::Accumulator& accumulator, const Board& parent, const Board& child, unsigned short index )
+    {
+        unsigned char before = parent.pieceAt( index );
+        unsigned char after = child.pieceAt( index );
+
+        if ( before != after )
+        {
+            if ( !Piece::isEmpty( before ) )
+            {
+                Network::removePiece( accumulator, before, index );
+            }
+            if ( !Piece::isEmpty( after ) )
+            {
+                Network::addPiece( accumulator, after, index );
+            }
+        }
+    }
+
+public:
+    AccumulatorStack()
+    {
+        accumulators.resize( INITIAL_PLIES );
+    }
+
+    virtual ~AccumulatorStack()
+    {
+        // Nothing to do
+    }
+
+    /// <summary>
+    /// Build an accumulator from scratch, from the pieces on a board
+    /// </summary>
+    inline static void build( const Board& board, Network::Accumulator& accumulator )
+    {
+        Network::resetAccumulator( accumulator );
+
+        for ( unsigned short index = 0; index < 64; index++ )
+        {
+            if ( !board.isEmpty( index ) )
+            {
+                Network::addPiece( accumulator, board.pieceAt( index ), index );
+            }
+        }
+    }
+
+    inline const Network::Accumulator& get( unsigned short ply ) const
+    {
+        return accumulators[ ply ];
+    }
+
+    /// <summary>
+    /// Build the accumulator at a ply, usually the root, from the pieces on its board
+    /// </summary>
+    inline void refresh( unsigned short ply, const Board& board )
+    {
+        if ( ply >= accumulators.size() )
+        {
+            accumulators.resize( static_cast<size_t>( ply ) + 1 );
+        }
+
+        build( board, accumulators[ ply ] );
+    }
+
+    /// <summary>
+    /// Derive the accumulator for the next ply from this one, from the squares a move changed
+    /// </summary>
+    /// <param name="ply">the ply of the position moved from, whose accumulator is up to date</param>
+    /// <param name="parent">the position moved from</param>
+    /// <param name="child">the position moved to</param>
+    /// <param name="move">the move made</param>
+    inline void update( unsigned short ply, const Board& parent, const Board& child, const Move& move )
+    {
+        if ( static_cast<size_t>( ply ) + 1 >= accumulators.size() )
+        {
+            accumulators.resize( static_cast<size_t>( ply ) + 2 );
+        }
+
+        Network::Accumulator& accumulator = accumulators[ ply + 1 ];
+        accumulator = accumulators[ ply ];
+
+        const unsigned short from = move.getFrom();
+        const unsigned short to = move.getTo();
+        const unsigned char piece = parent.pieceAt( from );
+
+        updateSquare( accumulator, parent, child, from );
+        updateSquare( accumulator, parent, child, to );
+
+        if ( Piece::isKing( piece ) && ( from > to ? from - to : to - from ) == 2 )
+        {
+            // Castling - the rook comes from the corner and lands between the king's squares
+            updateSquare( accumulator, parent, child, to > from ? to + 1 : to - 2 );
+            updateSquare( accumulator, parent, child, ( from + to ) / 2 );
+        }
+        else if ( Piece::isPawn( piece ) && ( from & 7 ) != ( to & 7 ) && parent.isEmpty( to ) )
+        {
+            // En passant - the captured pawn is beside the square moved from
+            updateSquare( accumulator, parent, child, ( from & ~7 ) | ( to & 7 ) );
+        }
+    }
+};
@@ -0,0 +1,203 @@
+#include "AsyncLogDestination.h"
+
+#include <algorithm>
+#include <cstring>
+
+thread_local AsyncLogDestination::Lease AsyncLogDestination::lease;
+
+AsyncLogDestination::AsyncLogDestination( Log::Destination* target, Overflow overflow ) :
+    Log::Destination( target->getLevel() ),
+    id( nextId++ ),
+    target( target ),
+    overflow( overflow ),
+    writer( &AsyncLogDestination::run, this )
+{
+    // Nothing to do here
+}
+
+AsyncLogDestination::~AsyncLogDestination()
+{
+    stopping.store( true, std::memory_order_release );
+    wake.notify_one();
+    writer.join();
+
+    delete target;
+}
+
+void AsyncLogDestination::setLevel( Log::Level level )
+{
+    this->level = level;
+    target->setLevel( level );
+}
+
+void AsyncLogDestination::write( Log::Level level, const char* message )
+{
+    push( getRing(), level, std::chrono::system_clock::now(), message );
+}
+
+AsyncLogDestination::Ring& AsyncLogDestination::getRing()
+{
+    if ( lease.owner == id )
+    {
+        return *lease.ring;
+    }
+
+    // First message from this thread, or the first since the destination was replaced
+    if ( lease.ring != nullptr )
+    {
+        lease.ring->leased.store( false, std::memory_order_release );
+    }
+
+    std::lock_guard<std::mutex> guard( ringsMutex );
+
+    std::shared_ptr<Ring> ring;
+    for ( const std::shared_ptr<Ring>& candidate : rings )
+    {
+        bool leased = false;
+        if ( candidate->leased.compare_exchange_strong( leased, true, std::memory_order_acquire ) )
+        {
+            ring = candidate;
+            break;
+        }
+    }
+
+    if ( ring == nullptr )
+    {
+        ring = std::make_shared<Ring>();
+        ring->leased.store( true, std::memory_order_relaxed );
+        rings.push_back( ring );
+    }
+
+    lease.owner = id;
+    lease.ring = ring;
+
+    return *ring;
+}
+
+void AsyncLogDestination::push( Ring& ring, Log::Level level, std::chrono::system_clock::time_point time, const char* message )
+{
+    // Anything too long for the whole ring is cut short
+    size_t length = std::min( strlen( message ), RING_RECORDS * RECORD_TEXT_SIZE );
+    size_t count = std::max<size_t>( 1, ( length + RECORD_TEXT_SIZE - 1 ) / RECORD_TEXT_SIZE );
+
+    const size_t head = ring.head.load( std::memory_order_relaxed );
+    while ( head + count - ring.tail.load( std::memory_order_acquire ) > RING_RECORDS )
+    {
+        if ( overflow == Overflow::DROP )
+        {
+            dropped.fetch_add( 1, std::memory_order_relaxed );
+            return;
+        }
+
+        wake.notify_one();
+        std::this_thread::sleep_for( std::chrono::microseconds( 100 ) );
+    }
+
+    for ( size_t index = 0; index < count; index++ )
+    {
+        Record& record = ring.records[ ( head + index ) % RING_RECORDS ];
+
+        size_t part = std::min( length, RECORD_TEXT_SIZE );
+
+        record.time = time;
+        record.level = level;
+        record.continued = index + 1 < count;
+        record.length = static_cast<unsigned char>( part );
+        memcpy( record.text, message, part );
+
+        message += part;
+        length -= part;
+    }
+
+    // Publish every part of the message at once, so the background thread never sees half of one
+    ring.head.store( head + count, std::memory_order_release );
+
+    // Otherwise leave the background thread to find it when it next wakes, saving the cost of waking it
+    if ( head + count - ring.tail.load( std::memory_order_relaxed ) > RING_RECORDS / 2 )
+    {
+        wake.notify_one();
+    }
+}
+
+void AsyncLogDestination::run()
+{
+    // Reused for each message, so formatting allocates only while the longest message so far is growing
+    std::string message;
+
+    while ( true )
+    {
+        // Read before draining, so that anything logged before the destructor was called is written
+        bool isStopping = stopping.load( std::memory_order_acquire );
+
+        bool wroteSomething = drain( message );
+
+        reportDropped();
+
+        if ( wroteSomething )
+        {
+            // One flush for the whole batch
+            target->flush();
+        }
+        else if ( isStopping )
+        {
+            break;
+        }
+        else
+        {
+            std::unique_lock<std::mutex> lock( wakeMutex );
+            wake.wait_for( lock, IDLE_WAIT );
+        }
+    }
+
+    target->flush();
+}
+
+bool AsyncLogDestination::drain( std::string& message )
+{
+    {
+        std::lock_guard<std::mutex> guard( ringsMutex );
+        snapshot.assign( rings.begin(), rings.end() );
+    }
+
+    bool wroteSomething = false;
+
+    for ( const std::shared_ptr<Ring>& ring : snapshot )
+    {
+        size_t tail = ring->tail.load( std::memory_order_relaxed );
+        const size_t head = ring->head.load( std::memory_order_acquire );
+
+        while ( tail < head )
+        {
+            const Record& first = ring->records[ tail % RING_RECORDS ];
+
+            // Gather up the parts of a long message
+            message.clear();
+            bool continued = true;
+            while ( continued )
+            {
+                const Record& record = ring->records[ tail++ % RING_RECORDS ];
+                message.append( record.text, record.length );
+                continued = record.continued;
+            }
+
+            target->append( first.level, first.time, message.c_str() );
+            wroteSomething = true;
+        }
+
+        // Hand the records back to the producer
+        ring->tail.store( tail, std::memory_order_release );
+    }
+
+    return wroteSomething;
+}
+
+void AsyncLogDestination::reportDropped()
+{
+    unsigned long long count = dropped.exchange( 0, std::memory_order_relaxed );
+
+    if ( count > 0 && target->isIncluded( Log::Level::WARN ) )
+    {
+        std::string message = std::to_string( count ) + " log message(s) dropped, logged faster than they could be written";
+        target->append( Log::Level::WARN, std::chrono::system_clock::now(), message.c_str() );
+    }
+}
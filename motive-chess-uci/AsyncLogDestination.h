@@ -0,0 +1,132 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "Log.h"
+
+/// <summary>
+/// A log destination that hands messages to a background thread, which formats them and writes them to another
+/// destination in batches. Each logging thread has its own lock-free ring buffer, so logging a message is a copy
+/// into memory that no other thread writes to - no mutex, no timestamp formatting and no I/O on the caller's thread
+/// </summary>
+class AsyncLogDestination : public Log::Destination
+{
+public:
+    enum class Overflow
+    {
+        DROP,   // Discard messages logged while the thread's buffer is full, counting them, rather than wait
+        BLOCK   // Wait for the background thread to make room, so nothing is lost
+    };
+
+private:
+    // Messages are copied into fixed size records, a long message taking several consecutive ones
+    inline static const size_t RECORD_TEXT_SIZE = 240;
+    inline static const size_t RING_RECORDS = 1024;
+
+    // How long the background thread sleeps when there is nothing to write
+    inline static const std::chrono::milliseconds IDLE_WAIT = std::chrono::milliseconds( 10 );
+
+    class Record
+    {
+    public:
+        std::chrono::system_clock::time_point time;
+        Log::Level level;
+        bool continued;
+        unsigned char length;
+        char text[ RECORD_TEXT_SIZE ];
+    };
+
+    /// <summary>
+    /// Single producer, single consumer queue of records. The producer only ever advances head, the consumer only
+    /// ever advances tail, and both only grow, so the number in use is always head - tail
+    /// </summary>
+    class Ring
+    {
+    public:
+        Record records[ RING_RECORDS ];
+
+        alignas( 64 ) std::atomic<size_t> head = 0;
+        alignas( 64 ) std::atomic<size_t> tail = 0;
+
+        // Whether a thread is writing to this ring. Rings are recycled when their thread exits
+        std::atomic<bool> leased = false;
+    };
+
+    /// <summary>
+    /// A thread's claim on a ring, released when the thread exits so that the short-lived search threads
+    /// don't leave a trail of rings behind them
+    /// </summary>
+    class Lease
+    {
+    public:
+        unsigned long long owner;
+        std::shared_ptr<Ring> ring;
+
+        Lease() :
+            owner( 0 )
+        {
+            // Nothing to do here
+        }
+
+        virtual ~Lease()
+        {
+            if ( ring != nullptr )
+            {
+                ring->leased.store( false, std::memory_order_release );
+            }
+        }
+    };
+
+    inline static std::atomic<unsigned long long> nextId = 1;
+    static thread_local Lease lease;
+
+    const unsigned long long id;
+    Log::Destination* target;
+    const Overflow overflow;
+
+    std::mutex ringsMutex;
+    std::vector<std::shared_ptr<Ring>> rings;
+
+    // The background thread's copy of the rings, taken each pass so that new threads can register meanwhile
+    std::vector<std::shared_ptr<Ring>> snapshot;
+
+    std::atomic<unsigned long long> dropped = 0;
+
+    std::mutex wakeMutex;
+    std::condition_variable wake;
+    std::atomic<bool> stopping = false;
+    std::thread writer;
+
+    Ring& getRing();
+
+    void push( Ring& ring, Log::Level level, std::chrono::system_clock::time_point time, const char* message );
+
+    void run();
+
+    bool drain( std::string& message );
+
+    void reportDropped();
+
+public:
+    /// <summary>
+    /// Start writing asynchronously to a destination
+    /// </summary>
+    /// <param name="target">where to write the messages, owned by this destination from now on</param>
+    /// <param name="overflow">what to do with messages logged while the logging thread's buffer is full</param>
+    AsyncLogDestination( Log::Destination* target, Overflow overflow = Overflow::DROP );
+
+    /// <summary>
+    /// Stops the background thread once everything already logged has been written
+    /// </summary>
+    virtual ~AsyncLogDestination();
+
+    void setLevel( Log::Level level ) override;
+
+    void write( Log::Level level, const char* message ) override;
+};
@@ -1,121 +1,225 @@
 #pragma once
 
-#include <bitset>
-#include <memory>
-#include <mutex>
+#include <array>
 
 class Bitboard
 {
 private:
-    static std::unique_ptr<Bitboard> instance;
+    typedef std::array<unsigned long long, 64> Table;
 
-    static unsigned long long whitePawnMoves[ 64 ];
-    static unsigned long long whitePawnCaptures[ 64 ];
-    static unsigned long long blackPawnMoves[ 64 ];
-    static unsigned long long blackPawnCaptures[ 64 ];
+    // All tables are generated at compile time by the constexpr builders below, so they live in
+    // read-only data and are ready before any code, including static initializers, can use them
+    static const Table whitePawnMoves;
+    static const Table whitePawnCaptures;
+    static const Table blackPawnMoves;
+    static const Table blackPawnCaptures;
 
-    static unsigned long long knightMoves[ 64 ];
-    static unsigned long long bishopMoves[ 64 ];
-    static unsigned long long rookMoves[ 64 ];
-    static unsigned long long queenMoves[ 64 ];
-    static unsigned long long kingMoves[ 64 ];
+    static const Table knightMoves;
+    static const Table bishopMoves;
+    static const Table rookMoves;
+    static const Table kingMoves;
 
-    static unsigned long long indexBitTable[ 64 ];
+    static const Table indexBitTable;
 
-    static unsigned long long diagonalMask[ 64 ];
-    static unsigned long long antidiagonalMask[ 64 ];
+    static const Table diagonalMask;
+    static const Table antidiagonalMask;
 
-    static void buildBitboards();
+    // Movement as ( file, rank ) offsets or directions
+    inline static constexpr short KNIGHT_OFFSETS[ 8 ][ 2 ] = { { 1, 2 }, { 2, 1 }, { 2, -1 }, { 1, -2 }, { -1, -2 }, { -2, -1 }, { -2, 1 }, { -1, 2 } };
+    inline static constexpr short KING_OFFSETS[ 8 ][ 2 ] = { { 0, 1 }, { 1, 1 }, { 1, 0 }, { 1, -1 }, { 0, -1 }, { -1, -1 }, { -1, 0 }, { -1, 1 } };
+    inline static constexpr short DIAGONAL_DIRECTIONS[ 4 ][ 2 ] = { { 1, 1 }, { 1, -1 }, { -1, -1 }, { -1, 1 } };
+    inline static constexpr short ORTHOGONAL_DIRECTIONS[ 4 ][ 2 ] = { { 0, 1 }, { 1, 0 }, { 0, -1 }, { -1, 0 } };
 
-    static unsigned long long bitboardFrom0x88( std::bitset<128>& bits );
-    static unsigned long long rotate180( unsigned long long x );
+    /// <summary>
+    /// Build a table of the squares reached by stepping once by each of a set of (file, rank) offsets,
+    /// ignoring any that would leave the board
+    /// </summary>
+    template<size_t N>
+    static constexpr Table buildStepTable( const short ( &offsets )[ N ][ 2 ] )
+    {
+        Table table{};
 
-    static unsigned long long getDiagonalMaskImpl( unsigned short file, unsigned short rank );
-    static unsigned long long getAntiDiagonalMaskImpl( unsigned short file, unsigned short rank );
+        for ( short index = 0; index < 64; index++ )
+        {
+            for ( const short* offset : offsets )
+            {
+                short file = ( index & 7 ) + offset[ 0 ];
+                short rank = ( index >> 3 ) + offset[ 1 ];
+
+                if ( file >= 0 && file < 8 && rank >= 0 && rank < 8 )
+                {
+                    table[ index ] |= 1ull << ( ( rank << 3 ) + file );
+                }
+            }
+        }
 
-public:
-    static void initialize()
+        return table;
+    }
+
+    /// <summary>
+    /// Build a table of the squares reached by sliding any distance by each of a set of (file, rank) directions,
+    /// on an otherwise empty board
+    /// </summary>
+    template<size_t N>
+    static constexpr Table buildSlideTable( const short ( &directions )[ N ][ 2 ] )
+    {
+        Table table{};
+
+        for ( short index = 0; index < 64; index++ )
+        {
+            for ( const short* direction : directions )
+            {
+                short file = ( index & 7 ) + direction[ 0 ];
+                short rank = ( index >> 3 ) + direction[ 1 ];
+
+                while ( file >= 0 && file < 8 && rank >= 0 && rank < 8 )
+                {
+                    table[ index ] |= 1ull << ( ( rank << 3 ) + file );
+
+                    file += direction[ 0 ];
+                    rank += direction[ 1 ];
+                }
+            }
+        }
+
+        return table;
+    }
+
+    static constexpr Table buildPawnMoves( bool isWhite )
+    {
+        Table table{};
+
+        // Single square advances, never from the back ranks, plus the double-square advance from the starting rank
+        for ( short index = 8; index < 56; index++ )
+        {
+            table[ index ] = isWhite ? 1ull << ( index + 8 ) : 1ull << ( index - 8 );
+
+            if ( ( index >> 3 ) == ( isWhite ? 1 : 6 ) )
+            {
+                table[ index ] |= isWhite ? 1ull << ( index + 16 ) : 1ull << ( index - 16 );
+            }
+        }
+
+        return table;
+    }
+
+    static constexpr Table buildPawnCaptures( bool isWhite )
+    {
+        // Pawns never stand on their own back rank, but these are also used for attack detection,
+        // so include every square from which there is a rank ahead
+        const short forward = isWhite ? 1 : -1;
+        const short offsets[ 2 ][ 2 ] = { { -1, forward }, { 1, forward } };
+
+        return buildStepTable( offsets );
+    }
+
+    static constexpr Table buildIndexBitTable()
+    {
+        Table table{};
+
+        for ( short index = 0; index < 64; index++ )
+        {
+            table[ index ] = 1ull << index;
+        }
+
+        return table;
+    }
+
+    /// <summary>
+    /// Build the full diagonal or antidiagonal line through each square, including the square itself
+    /// </summary>
+    static constexpr Table buildLineMasks( short fileDirection )
     {
-        buildBitboards();
+        const short directions[ 2 ][ 2 ] = { { fileDirection, 1 }, { static_cast<short>( -fileDirection ), -1 } };
+
+        Table table = buildSlideTable( directions );
+
+        for ( short index = 0; index < 64; index++ )
+        {
+            table[ index ] |= 1ull << index;
+        }
+
+        return table;
     }
 
-    inline static unsigned long long getPawnMoves( unsigned short index, bool isWhite )
+public:
+    inline static constexpr unsigned long long getPawnMoves( unsigned short index, bool isWhite )
     {
         return isWhite ? whitePawnMoves[ index ] : blackPawnMoves[ index ];
     }
 
-    inline static unsigned long long getPawnCaptures( unsigned short index, bool isWhite )
+    inline static constexpr unsigned long long getPawnCaptures( unsigned short index, bool isWhite )
     {
         return isWhite ? whitePawnCaptures[ index ] : blackPawnCaptures[ index ];
     }
 
-    inline static unsigned long long getKnightMoves( unsigned short index )
+    inline static constexpr unsigned long long getKnightMoves( unsigned short index )
     {
         return knightMoves[ index ];
     }
 
-    inline static unsigned long long getBishopMoves( unsigned short index )
+    inline static constexpr unsigned long long getBishopMoves( unsigned short index )
     {
         return bishopMoves[ index ];
     }
 
-    inline static unsigned long long getRookMoves( unsigned short index )
+    inline static constexpr unsigned long long getRookMoves( unsigned short index )
     {
         return rookMoves[ index ];
     }
 
-    inline static unsigned long long getQueenMoves( unsigned short index )
+    inline static constexpr unsigned long long getQueenMoves( unsigned short index )
     {
-        return queenMoves[ index ];
+        return bishopMoves[ index ] | rookMoves[ index ];
     }
 
-    inline static unsigned long long getKingMoves( unsigned short index )
+    inline static constexpr unsigned long long getKingMoves( unsigned short index )
     {
         return kingMoves[ index ];
     }
 
-    inline static unsigned long long getWhiteKingsideCastlingMask()
+    inline static constexpr unsigned long long getWhiteKingsideCastlingMask()
     {
         //       hgfedcba
         return 0b01100000ull;
     }
 
-    inline static unsigned long long getBlackKingsideCastlingMask()
+    inline static constexpr unsigned long long getBlackKingsideCastlingMask()
     {
         // This is the same as the black queenside castling mask << 56
         //       hgfedcba
         return 0b0110000000000000000000000000000000000000000000000000000000000000ull;
     }
 
-    inline static unsigned long long getWhiteQueensideCastlingMask()
+    inline static constexpr unsigned long long getWhiteQueensideCastlingMask()
     {
         //       hgfedcba
         return 0b00001110ull;
     }
 
-    inline static unsigned long long getBlackQueensideCastlingMask()
+    inline static constexpr unsigned long long getBlackQueensideCastlingMask()
     {
         // This is the same as the white queenside castling mask << 56
         //       hgfedcba
         return 0b0000111000000000000000000000000000000000000000000000000000000000ull;
     }
 
-    inline static unsigned long long getFileMask( unsigned short index )
+    inline static constexpr unsigned long long getFileMask( unsigned short index )
     {
         return 0x0101010101010101ull << ( index & 0b00000111 );
     }
 
-    inline static unsigned long long getRankMask( unsigned short index )
+    inline static constexpr unsigned long long getRankMask( unsigned short index )
     {
         return 0x00000000000000FFull << ( index & 0b00111000 );
     }
 
-    inline static unsigned long long getDiagonalMask( unsigned short index )
+    inline static constexpr unsigned long long getDiagonalMask( unsigned short index )
     {
         return diagonalMask[ index ];
     }
 
-    inline static unsigned long long getAntiDiagonalMask( unsigned short index )
+    inline static constexpr unsigned long long getAntiDiagonalMask( unsigned short index )
     {
         return antidiagonalMask[ index ];
     }
@@ -126,7 +230,7 @@ public:
     /// </summary>
     /// <param name="index">a square</param>
     /// <returns>a bitmask of the squares above 'index'</returns>
-    inline static unsigned long long makeUpperMask( unsigned short index )
+    inline static constexpr unsigned long long makeUpperMask( unsigned short index )
     {
         if ( index == 63 )
         {
@@ -142,7 +246,7 @@ public:
     /// </summary>
     /// <param name="index">a square</param>
     /// <returns>bitmask of the squares below 'index'</returns>
-    inline static unsigned long long makeLowerMask( unsigned short index )
+    inline static constexpr unsigned long long makeLowerMask( unsigned short index )
     {
         return ( 1ull << index ) - 1;
     }
@@ -154,12 +258,12 @@ public:
     /// <param name="from">the lower square index</param>
     /// <param name="to">the upper square index</param>
     /// <returns>an inclusive mask between the two extents</returns>
-    inline static unsigned long long makeMask( unsigned short from, unsigned short to )
+    inline static constexpr unsigned long long makeMask( unsigned short from, unsigned short to )
     {
         return ~makeLowerMask( from ) & ~makeUpperMask( to );
     }
 
-    inline static unsigned long long indexToBit( unsigned short index )
+    inline static constexpr unsigned long long indexToBit( unsigned short index )
     {
         return indexBitTable[ index ]; 
     }
@@ -197,3 +301,18 @@ public:
         return false;
     }
 };
+
+inline constexpr Bitboard::Table Bitboard::whitePawnMoves = Bitboard::buildPawnMoves( true );
+inline constexpr Bitboard::Table Bitboard::whitePawnCaptures = Bitboard::buildPawnCaptures( true );
+inline constexpr Bitboard::Table Bitboard::blackPawnMoves = Bitboard::buildPawnMoves( false );
+inline constexpr Bitboard::Table Bitboard::blackPawnCaptures = Bitboard::buildPawnCaptures( false );
+
+inline constexpr Bitboard::Table Bitboard::knightMoves = Bitboard::buildStepTable( Bitboard::KNIGHT_OFFSETS );
+inline constexpr Bitboard::Table Bitboard::bishopMoves = Bitboard::buildSlideTable( Bitboard::DIAGONAL_DIRECTIONS );
+inline constexpr Bitboard::Table Bitboard::rookMoves = Bitboard::buildSlideTable( Bitboard::ORTHOGONAL_DIRECTIONS );
+inline constexpr Bitboard::Table Bitboard::kingMoves = Bitboard::buildStepTable( Bitboard::KING_OFFSETS );
+
+inline constexpr Bitboard::Table Bitboard::indexBitTable = Bitboard::buildIndexBitTable();
+
+inline constexpr Bitboard::Table Bitboard::diagonalMask = Bitboard::buildLineMasks( 1 );
+inline constexpr Bitboard::Table Bitboard::antidiagonalMask = Bitboard::buildLineMasks( -1 );
@@ -1,6 +1,7 @@
 #include "Board.h"
 
 #include <algorithm>
+#include <bit>
 
 #include "Bitboard.h"
 
@@ -28,6 +29,9 @@ void Board::applyMove( const Move& move )
         return;
     }
 
+    // Take the current castling rights and en passant square out of the hash. The new ones go in at the end
+    hashKey ^= Zobrist::getCastlingKey( castlingRights ) ^ Zobrist::getEnPassantKey( enPassantIndex );
+
     // Store this for later tests
     unsigned char movingPiece = pieceAt( move.getFrom() ); // Will not be Piece::NOTHING
     unsigned char capturedPiece = pieceAt( move.getTo() ); // May be Piece::NOTHING
@@ -172,6 +176,8 @@ void Board::applyMove( const Move& move )
         }
     }
 
+    hashKey ^= Zobrist::getCastlingKey( castlingRights ) ^ Zobrist::getEnPassantKey( enPassantIndex ) ^ Zobrist::getBlackToMoveKey();
+
     // Halfmove increment? Only if not a capture or pawn move
     if ( Piece::isEmpty( capturedPiece ) && !Piece::isPawn( movingPiece ) )
     {
@@ -339,14 +345,455 @@ unsigned long long Board::movesInARay( unsigned long long possibleMoves,
     return moves;
 }
 
-std::vector<Move> Board::getMoves()
-{ 
-    bool isWhite = Piece::isWhite( activeColor );
+unsigned long long Board::bishopAttacks( unsigned short index, unsigned long long occupancy ) const
+{
+    unsigned long long possibleMoves = Bitboard::getBishopMoves( index );
 
-    // Worker variables
+    unsigned long long aboveMask = Bitboard::makeUpperMask( index );
+    unsigned long long belowMask = Bitboard::makeLowerMask( index );
+
+    // Treating every piece as capturable stops each ray at, but includes, the first piece it meets
+    return movesInARay( possibleMoves, Bitboard::getDiagonalMask( index ), 0, occupancy, aboveMask, belowMask )
+         | movesInARay( possibleMoves, Bitboard::getAntiDiagonalMask( index ), 0, occupancy, aboveMask, belowMask );
+}
+
+unsigned long long Board::rookAttacks( unsigned short index, unsigned long long occupancy ) const
+{
+    unsigned long long possibleMoves = Bitboard::getRookMoves( index );
+
+    unsigned long long aboveMask = Bitboard::makeUpperMask( index );
+    unsigned long long belowMask = Bitboard::makeLowerMask( index );
+
+    return movesInARay( possibleMoves, Bitboard::getRankMask( index ), 0, occupancy, aboveMask, belowMask )
+         | movesInARay( possibleMoves, Bitboard::getFileMask( index ), 0, occupancy, aboveMask, belowMask );
+}
+
+std::vector<Move> Board::getMoves()
+{
     std::vector<Move> moves;
 
-    unsigned long long mask = 1;
+    getPseudoLegalMoves( MoveGeneration::ALL, moves );
+
+    // Make each move and test whether it is really legal, not just pseudo legal
+    for ( std::vector<Move>::iterator it = moves.begin(); it != moves.end(); )
+    {
+        if ( isLegal( *it ) )
+        {
+            it++;
+        }
+        else
+        {
+            it = moves.erase( it );
+        }
+    }
+
+    Log::Trace( [&] ( const Log::Logger& logger )
+    {
+        for ( std::vector<Move>::iterator it = moves.begin(); it != moves.end(); it++ )
+        {
+            logger << (*it).toString() << ". Promotion? " << ( *it ).isPromotion() << ". Castling? " << ( *it ).isCastling() << std::endl;
+        }
+    } );
+
+    return moves;
+}
+
+void Board::getPseudoLegalMoves( MoveGeneration generation, std::vector<Move>& moves )
+{
+    // Choose the color once per node, rather than throughout generation
+    if ( Piece::isWhite( activeColor ) )
+    {
+        generate<true>( generation, moves );
+    }
+    else
+    {
+        generate<false>( generation, moves );
+    }
+}
+
+bool Board::isLegal( const Move& move )
+{
+    return Piece::isWhite( activeColor ) ? isLegal<true>( move ) : isLegal<false>( move );
+}
+
+template<bool isWhite>
+bool Board::isLegal( const Move& move )
+{
+    const unsigned short from = move.getFrom();
+    const unsigned short to = move.getTo();
+
+    if ( Piece::isKing( pieceAt( from ) ) )
+    {
+        // The king may not castle out of, through or into check
+        if ( move.isCastling() )
+        {
+            const short step = to > from ? 1 : -1;
+            for ( unsigned short index = from; index != to + step; index += step )
+            {
+                if ( attackersOf<!isWhite>( index, from ) )
+                {
+                    return false;
+                }
+            }
+
+            return true;
+        }
+
+        // Look through the king's current square, so it can't step back along the line of a slider checking it
+        return attackersOf<!isWhite>( to, from ) == 0;
+    }
+
+    // An en passant capture takes two pieces off the same rank, which can expose the king in ways a pin test
+    // doesn't see, but it's rare enough to simply play it out
+    if ( move.isEnPassantCapture() && !move.isPromotion() )
+    {
+        Board testBoard = makeMove( move );
+
+        return !testBoard.attackedBy<!isWhite>( testBoard.makePieceBitboard( Piece::ownKingPiece<isWhite>() ) );
+    }
+
+    const unsigned short king = static_cast<unsigned short>( std::find( pieces.begin(), pieces.end(), Piece::ownKingPiece<isWhite>() ) - pieces.begin() );
+
+    // A position set up without a king has none to leave in check, and no square to look up attacks from
+    if ( king == 64 )
+    {
+        return true;
+    }
+
+    // In check, the move must take the only checker or block its line to the king
+    unsigned long long checkers = attackersOf<!isWhite>( king, Utilities::getOffboardLocation() );
+    if ( checkers )
+    {
+        if ( std::popcount( checkers ) > 1 )
+        {
+            return false;
+        }
+
+        const unsigned short checker = static_cast<unsigned short>( std::countr_zero( checkers ) );
+        const short step = lineStep( king, checker );
+
+        if ( to != checker && ( step == 0 || lineStep( king, to ) != step || lineStep( to, checker ) != step ) )
+        {
+            return false;
+        }
+    }
+
+    // A piece pinned to its king can only move along the pin
+    const short step = lineStep( king, from );
+    if ( step != 0 && lineStep( king, to ) != step && isPathClear( king, from ) )
+    {
+        const bool diagonal = Utilities::indexToFile( from ) != Utilities::indexToFile( king ) && Utilities::indexToRank( from ) != Utilities::indexToRank( king );
+
+        for ( unsigned short index = from; lineStep( index, index + step ) == step; )
+        {
+            index += step;
+
+            const unsigned char piece = pieceAt( index );
+            if ( !Piece::isEmpty( piece ) )
+            {
+                return !( Piece::isWhite( piece ) != isWhite &&
+                          ( Piece::isQueen( piece ) || ( diagonal ? Piece::isBishop( piece ) : Piece::isRook( piece ) ) ) );
+            }
+        }
+    }
+
+    return true;
+}
+
+short Board::lineStep( unsigned short from, unsigned short to )
+{
+    if ( from == to || to > 63 )
+    {
+        return 0;
+    }
+
+    const short files = Utilities::indexToFile( to ) - Utilities::indexToFile( from );
+    const short ranks = Utilities::indexToRank( to ) - Utilities::indexToRank( from );
+
+    if ( files != 0 && ranks != 0 && files != ranks && files != -ranks )
+    {
+        return 0;
+    }
+
+    return ( ( ranks > 0 ) - ( ranks < 0 ) ) * 8 + ( files > 0 ) - ( files < 0 );
+}
+
+template<bool byWhite>
+unsigned long long Board::attackersOf( unsigned short index, unsigned short ignore ) const
+{
+    unsigned long long attackers = 0;
+
+    auto isAttacker = [&] ( unsigned short square, bool ( *isType )( unsigned char ) )
+    {
+        const unsigned char piece = pieceAt( square );
+
+        return !Piece::isEmpty( piece ) && Piece::isWhite( piece ) == byWhite && isType( piece );
+    };
+
+    // Step attacks are reflections: a square is attacked from wherever its own piece could capture
+    unsigned short square;
+    unsigned long long candidates = Bitboard::getPawnCaptures( index, !byWhite );
+    while ( Bitboard::getEachIndexForward( &square, candidates ) )
+    {
+        if ( isAttacker( square, Piece::isPawn ) )
+        {
+            attackers |= Bitboard::indexToBit( square );
+        }
+    }
+
+    candidates = Bitboard::getKnightMoves( index );
+    while ( Bitboard::getEachIndexForward( &square, candidates ) )
+    {
+        if ( isAttacker( square, Piece::isKnight ) )
+        {
+            attackers |= Bitboard::indexToBit( square );
+        }
+    }
+
+    candidates = Bitboard::getKingMoves( index );
+    while ( Bitboard::getEachIndexForward( &square, candidates ) )
+    {
+        if ( isAttacker( square, Piece::isKing ) )
+        {
+            attackers |= Bitboard::indexToBit( square );
+        }
+    }
+
+    // Sliders - walk out from the square to the first piece in each direction, as ( file, rank ) steps
+    static const short directions[ 8 ][ 2 ] = { { 0, 1 }, { 1, 1 }, { 1, 0 }, { 1, -1 }, { 0, -1 }, { -1, -1 }, { -1, 0 }, { -1, 1 } };
+
+    for ( unsigned short direction = 0; direction < 8; direction++ )
+    {
+        const bool diagonal = directions[ direction ][ 0 ] != 0 && directions[ direction ][ 1 ] != 0;
+
+        short file = Utilities::indexToFile( index ) + directions[ direction ][ 0 ];
+        short rank = Utilities::indexToRank( index ) + directions[ direction ][ 1 ];
+
+        for ( ; file >= 0 && file < 8 && rank >= 0 && rank < 8; file += directions[ direction ][ 0 ], rank += directions[ direction ][ 1 ] )
+        {
+            square = Utilities::squareToIndex( file, rank );
+
+            if ( square == ignore || isEmpty( square ) )
+            {
+                continue;
+            }
+
+            if ( isAttacker( square, Piece::isQueen ) || isAttacker( square, diagonal ? Piece::isBishop : Piece::isRook ) )
+            {
+                attackers |= Bitboard::indexToBit( square );
+            }
+            break;
+        }
+    }
+
+    return attackers;
+}
+
+bool Board::isPseudoLegal( const Move& move ) const
+{
+    return !move.isNullMove() && completeMove( move ) == move;
+}
+
+Move Board::completeMove( const Move& move ) const
+{
+    if ( move.isNullMove() )
+    {
+        return Move::nullMove;
+    }
+
+    const unsigned short from = move.getFrom();
+    const unsigned short to = move.getTo();
+
+    const unsigned char piece = pieceAt( from );
+    const unsigned char target = pieceAt( to );
+
+    // Must move one of our own pieces, and not onto another of our own
+    if ( !Piece::isColor( piece, activeColor ) || Piece::isColor( target, activeColor ) )
+    {
+        return Move::nullMove;
+    }
+
+    const bool isWhite = Piece::isWhite( activeColor );
+    const unsigned long long destination = Bitboard::indexToBit( to );
+
+    // Work out the move the generator would have made between these squares, flags and all
+    Move::Builder builder = Move::createBuilder( from, to );
+
+    if ( Piece::isPawn( piece ) )
+    {
+        const short forward = isWhite ? 8 : -8;
+
+        if ( Bitboard::getPawnCaptures( from, isWhite ) & destination )
+        {
+            if ( to == enPassantIndex )
+            {
+                builder.setEnPassantCapture();
+            }
+            else if ( !Piece::isEmpty( target ) )
+            {
+                builder.setCapture();
+            }
+            else
+            {
+                return Move::nullMove;
+            }
+        }
+        else if ( !Piece::isEmpty( target ) )
+        {
+            return Move::nullMove;
+        }
+        else if ( to != from + forward )
+        {
+            // Only a double push from the starting rank, and only if not blocked
+            if ( to != from + 2 * forward || Utilities::indexToRank( from ) != ( isWhite ? 1 : 6 ) || !isEmpty( from + forward ) )
+            {
+                return Move::nullMove;
+            }
+        }
+
+        if ( Utilities::indexToRank( to ) == ( isWhite ? 7 : 0 ) )
+        {
+            if ( !move.isPromotion() )
+            {
+                return Move::nullMove;
+            }
+
+            builder.setPromotion( move.getPromotionPiece( activeColor ) );
+        }
+        else if ( move.isPromotion() )
+        {
+            return Move::nullMove;
+        }
+    }
+    else if ( move.isPromotion() )
+    {
+        return Move::nullMove;
+    }
+    else if ( Piece::isKing( piece ) && ( to == from + 2 || to == from - 2 ) )
+    {
+        const bool kingside = to > from;
+
+        bool allowed;
+        unsigned long long mask;
+        if ( isWhite )
+        {
+            allowed = from == E1 && ( kingside ? castlingRights.canWhiteCastleKingside() : castlingRights.canWhiteCastleQueenside() );
+            mask = kingside ? Bitboard::getWhiteKingsideCastlingMask() : Bitboard::getWhiteQueensideCastlingMask();
+        }
+        else
+        {
+            allowed = from == E8 && ( kingside ? castlingRights.canBlackCastleKingside() : castlingRights.canBlackCastleQueenside() );
+            mask = kingside ? Bitboard::getBlackKingsideCastlingMask() : Bitboard::getBlackQueensideCastlingMask();
+        }
+
+        // The squares between king and rook must be empty
+        unsigned short index;
+        while ( allowed && Bitboard::getEachIndexForward( &index, mask ) )
+        {
+            allowed = isEmpty( index );
+        }
+
+        if ( !allowed )
+        {
+            return Move::nullMove;
+        }
+
+        if ( kingside )
+        {
+            builder.setKingsideCastling();
+        }
+        else
+        {
+            builder.setQueensideCastling();
+        }
+    }
+    else
+    {
+        unsigned long long reach = 0;
+
+        if ( Piece::isKnight( piece ) )
+        {
+            reach = Bitboard::getKnightMoves( from );
+        }
+        else if ( Piece::isBishop( piece ) )
+        {
+            reach = Bitboard::getBishopMoves( from );
+        }
+        else if ( Piece::isRook( piece ) )
+        {
+            reach = Bitboard::getRookMoves( from );
+        }
+        else if ( Piece::isQueen( piece ) )
+        {
+            reach = Bitboard::getQueenMoves( from );
+        }
+        else if ( Piece::isKing( piece ) )
+        {
+            reach = Bitboard::getKingMoves( from );
+        }
+
+        if ( ( reach & destination ) == 0 )
+        {
+            return Move::nullMove;
+        }
+
+        // Sliders must not jump over anything
+        if ( ( Piece::isBishop( piece ) || Piece::isRook( piece ) || Piece::isQueen( piece ) ) && !isPathClear( from, to ) )
+        {
+            return Move::nullMove;
+        }
+
+        if ( !Piece::isEmpty( target ) )
+        {
+            builder.setCapture();
+        }
+    }
+
+    return builder.build();
+}
+
+bool Board::isPathClear( unsigned short from, unsigned short to ) const
+{
+    const short fileStep = ( Utilities::indexToFile( to ) > Utilities::indexToFile( from ) ) - ( Utilities::indexToFile( to ) < Utilities::indexToFile( from ) );
+    const short rankStep = ( Utilities::indexToRank( to ) > Utilities::indexToRank( from ) ) - ( Utilities::indexToRank( to ) < Utilities::indexToRank( from ) );
+    const short step = rankStep * 8 + fileStep;
+
+    for ( unsigned short index = from + step; index != to; index += step )
+    {
+        if ( !isEmpty( index ) )
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool Board::isInCheck() const
+{
+    unsigned long long king = makePieceBitboard( Piece::ownKingPiece( activeColor ) );
+
+    return failsCheckTests( king, !Piece::isWhite( activeColor ) );
+}
+
+unsigned long long Board::getCheckers() const
+{
+    const unsigned short king = static_cast<unsigned short>( std::find( pieces.begin(), pieces.end(), Piece::ownKingPiece( activeColor ) ) - pieces.begin() );
+
+    // No king, as a position set up from a FEN string may have, means nothing to check
+    if ( king == 64 )
+    {
+        return 0;
+    }
+
+    return Piece::isWhite( activeColor ) ? attackersOf<false>( king, Utilities::getOffboardLocation() )
+                                         : attackersOf<true>( king, Utilities::getOffboardLocation() );
+}
+
+template<bool isWhite>
+void Board::generate( MoveGeneration generation, std::vector<Move>& moves )
+{
+    // Worker variables
     unsigned short index;
     unsigned short destination;
     unsigned long long pieces;
@@ -357,69 +804,90 @@ std::vector<Move> Board::getMoves()
     PieceBitboards enemy;
     makePieceBitboards( isWhite, own, enemy );
 
-    const unsigned short promotionRank = isWhite ? 7 : 0;
+    constexpr unsigned short promotionRank = isWhite ? 7 : 0;
 
     const unsigned long long emptySquares = ~( own.allMask() | enemy.allMask() );
-    const unsigned long long ownOrEmpty = own.allMask() | emptySquares;
-    const unsigned long long enemyOrEmpty = enemy.allMask() | emptySquares;
+
+    // Captures and quiet moves can be generated separately, or together
+    const bool wantCaptures = generation != MoveGeneration::QUIETS;
+    const bool wantQuiets = generation != MoveGeneration::CAPTURES;
+
+    const unsigned long long targets = ( wantCaptures ? enemy.allMask() : 0 ) | ( wantQuiets ? emptySquares : 0 );
 
     // Generate possible moves
 
-    // Iterate through all pieces by popping them out of the mask
-    pieces = own.pawnMask();
-    while ( Bitboard::getEachIndexForward( &index, pieces ) )
+    // Pawns are handled set-wise: shift all of them at once to find each kind of move, and then
+    // recover each origin square from its destination by undoing the shift
     {
-        // Determine piece moves
-        unsigned long long setOfMoves = 0;
+        constexpr short forward = isWhite ? 8 : -8;
 
-        unsigned long long possibleMoves = Bitboard::getPawnMoves( index, isWhite );
-        unsigned long long possibleCaptures = Bitboard::getPawnCaptures( index, isWhite );
+        constexpr unsigned long long notFileA = ~Bitboard::getFileMask( 0 );
+        constexpr unsigned long long notFileH = ~Bitboard::getFileMask( 7 );
+        constexpr unsigned long long promotionRankMask = Bitboard::getRankMask( promotionRank << 3 );
+        constexpr unsigned long long doublePushRankMask = Bitboard::getRankMask( ( isWhite ? 3 : 4 ) << 3 );
 
-        unsigned long long aboveMask = Bitboard::makeUpperMask( index );
-        unsigned long long belowMask = Bitboard::makeLowerMask( index );
+        auto shift = [] ( unsigned long long bits, short by )
+        {
+            return by > 0 ? bits << by : bits >> -by;
+        };
 
-        // Masks for specific directions of travel
-        unsigned long long fileMask = Bitboard::getFileMask( index );
+        const unsigned long long pawns = own.pawnMask();
 
-        setOfMoves |= movesInARay( possibleMoves, fileMask, own.allMask(), enemy.allMask(), aboveMask, belowMask, false);
+        // Pushes, with the double push only for pawns whose single push landed on the third (or sixth) rank.
+        // Promotions go with the captures, as they also change the material balance
+        const unsigned long long pushMask = ( wantQuiets ? ~promotionRankMask : 0 ) | ( wantCaptures ? promotionRankMask : 0 );
 
-        // Include captures, include en passant
-        possibleCaptures &= ( Utilities::isOffboard( enPassantIndex ) ? enemy.allMask() : ( enemy.allMask() | 1ull << enPassantIndex ) );
+        const unsigned long long singlePushes = shift( pawns, forward ) & emptySquares;
+        const unsigned long long doublePushes = wantQuiets ? shift( singlePushes, forward ) & emptySquares & doublePushRankMask : 0;
 
-        setOfMoves |= possibleCaptures;
+        // Captures towards the a-file and the h-file, including en passant
+        const unsigned long long captureTargets = !wantCaptures ? 0 : Utilities::isOffboard( enPassantIndex ) ? enemy.allMask() : ( enemy.allMask() | 1ull << enPassantIndex );
 
-        while ( Bitboard::getEachIndexForward( &destination, setOfMoves ) )
+        const unsigned long long leftCaptures = shift( pawns & notFileA, forward - 1 ) & captureTargets;
+        const unsigned long long rightCaptures = shift( pawns & notFileH, forward + 1 ) & captureTargets;
+
+        auto addPawnMoves = [&] ( unsigned long long targets, short offset )
         {
-            // Promotions lead to extra moves
-            if ( Utilities::indexToRank( destination ) == promotionRank )
+            while ( Bitboard::getEachIndexForward( &destination, targets ) )
             {
-                // Promote to...
-                const unsigned char* promotionPieces = Piece::getPromotionPieces( activeColor );
-                for ( unsigned int loop = 0; loop < Piece::numberOfPromotionPieces; loop++ )
+                index = destination - offset;
+
+                // Promotions lead to extra moves
+                if ( Bitboard::indexToBit( destination ) & promotionRankMask )
+                {
+                    // Promote to...
+                    const unsigned char* promotionPieces = Piece::getPromotionPieces<isWhite>();
+                    for ( unsigned int loop = 0; loop < Piece::numberOfPromotionPieces; loop++ )
+                    {
+                        Move::Builder builder = Move::createBuilder( index, destination );
+                        builder.setPromotion( promotionPieces[ loop ] );
+                        if ( !isEmpty( destination ) )
+                        {
+                            builder.setCapture();
+                        }
+                        moves.push_back( builder.build() );
+                    }
+                }
+                else
                 {
                     Move::Builder builder = Move::createBuilder( index, destination );
-                    builder.setPromotion( promotionPieces[ loop ] );
-                    if ( !isEmpty( destination ) )
+                    if ( destination == enPassantIndex )
+                    {
+                        builder.setEnPassantCapture();
+                    }
+                    else if ( !isEmpty( destination ) )
                     {
                         builder.setCapture();
                     }
                     moves.push_back( builder.build() );
                 }
             }
-            else
-            {
-                Move::Builder builder = Move::createBuilder( index, destination );
-                if ( destination == enPassantIndex )
-                {
-                    builder.setEnPassantCapture();
-                }
-                else if ( !isEmpty( destination ) )
-                {
-                    builder.setCapture();
-                }
-                moves.push_back( builder.build() );
-            }
-        }
+        };
+
+        addPawnMoves( singlePushes & pushMask, forward );
+        addPawnMoves( doublePushes, forward * 2 );
+        addPawnMoves( leftCaptures, forward - 1 );
+        addPawnMoves( rightCaptures, forward + 1 );
     }
 
     pieces = own.knightMask();
@@ -427,7 +895,7 @@ std::vector<Move> Board::getMoves()
     {
         // Determine piece moves
         unsigned long long setOfMoves = Bitboard::getKnightMoves( index );
-        setOfMoves &= enemyOrEmpty;
+        setOfMoves &= targets;
 
         while ( Bitboard::getEachIndexForward( &destination, setOfMoves ) )
         {
@@ -460,6 +928,7 @@ std::vector<Move> Board::getMoves()
         unsigned long long antiMask = Bitboard::getAntiDiagonalMask( index );
 
         setOfMoves |= movesInARay( possibleMoves, antiMask, own.allMask(), enemy.allMask(), aboveMask, belowMask );
+        setOfMoves &= targets;
 
         while ( Bitboard::getEachIndexForward( &destination, setOfMoves ) )
         {
@@ -492,6 +961,7 @@ std::vector<Move> Board::getMoves()
         unsigned long long fileMask = Bitboard::getFileMask( index );
         
         setOfMoves |= movesInARay( possibleMoves, fileMask, own.allMask(), enemy.allMask(), aboveMask, belowMask );
+        setOfMoves &= targets;
 
         while ( Bitboard::getEachIndexForward( &destination, setOfMoves ) )
         {
@@ -509,7 +979,7 @@ std::vector<Move> Board::getMoves()
     {
         // Determine piece moves
         unsigned long long setOfMoves = Bitboard::getKingMoves( index );
-        setOfMoves &= enemyOrEmpty;
+        setOfMoves &= targets;
 
         while ( Bitboard::getEachIndexForward( &destination, setOfMoves ) )
         {
@@ -526,7 +996,7 @@ std::vector<Move> Board::getMoves()
         unsigned long long kingsideMask;
         unsigned long long queensideMask;
 
-        if ( isWhite )
+        if constexpr ( isWhite )
         {
             kingside = castlingRights.canWhiteCastleKingside();
             queenside = castlingRights.canWhiteCastleQueenside();
@@ -541,7 +1011,7 @@ std::vector<Move> Board::getMoves()
             queensideMask = Bitboard::getBlackQueensideCastlingMask();
         }
 
-        if ( kingside )
+        if ( kingside && wantQuiets )
         {
             if ( ( kingsideMask & emptySquares ) == kingsideMask )
             {
@@ -550,7 +1020,7 @@ std::vector<Move> Board::getMoves()
             }
         }
 
-        if ( queenside )
+        if ( queenside && wantQuiets )
         {
             if ( ( queensideMask & emptySquares ) == queensideMask )
             {
@@ -559,52 +1029,6 @@ std::vector<Move> Board::getMoves()
             }
         }
     }
-
-    // Make the move and test whether it is really legal, not just pseudo legal
-    unsigned long long protectedSquares;
-    for ( std::vector<Move>::iterator it = moves.begin(); it != moves.end(); )
-    {
-        Move& move = *it;
-        Board testBoard = makeMove( move );
-
-        // Which squares are we testing? Just the king for check, or the squares it passes
-        // through when castling
-        if ( move.isCastling() )
-        {
-            if ( move.isKingsideCastle() )
-            {
-                protectedSquares = ( isWhite ? 0b01110000ull : 0b01110000ull << 56 );
-            }
-            else // if ( move.isQueensideCastle() )
-            {
-                protectedSquares = ( isWhite ? 0b00011100ull : 0b00011100ull << 56 );
-            }
-        }
-        else
-        {
-            protectedSquares = testBoard.makePieceBitboard( Piece::ownKingPiece( activeColor) );
-        }
-
-        if ( testBoard.failsCheckTests( protectedSquares, !Piece::isWhite( activeColor ) ) )
-        {
-            it = moves.erase( it );
-        }
-        else
-        {
-            // Move is fine, go on to the next one
-            it++;
-        }
-    }
-
-    Log::Trace( [&] ( const Log::Logger& logger )
-    {
-        for ( std::vector<Move>::iterator it = moves.begin(); it != moves.end(); it++ )
-        {
-            logger << (*it).toString() << ". Promotion? " << ( *it ).isPromotion() << ". Castling? " << ( *it ).isCastling() << std::endl;
-        }
-    } );
-
-    return moves;
 }
 
 /// <summary>
@@ -617,6 +1041,12 @@ std::vector<Move> Board::getMoves()
 /// <param name="protectedSquares">bitmask of square or squares to test</param>
 /// <returns>true if a square is under attack</returns>
 bool Board::failsCheckTests( unsigned long long protectedSquares, bool asWhite ) const
+{
+    return asWhite ? attackedBy<true>( protectedSquares ) : attackedBy<false>( protectedSquares );
+}
+
+template<bool isWhite>
+bool Board::attackedBy( unsigned long long protectedSquares ) const
 {
     // If any of the protected squares are attacked by this player, the test fails and should return true immediately
     // This will be called after making our move and so the state should be as though the opponent was about to play
@@ -626,7 +1056,7 @@ bool Board::failsCheckTests( unsigned long long protectedSquares, bool asWhite )
 
     PieceBitboards own;
     PieceBitboards enemy;
-    makePieceBitboards( !asWhite, own, enemy );
+    makePieceBitboards( !isWhite, own, enemy );
 
     // Worker variables
     unsigned short index;
@@ -638,7 +1068,7 @@ bool Board::failsCheckTests( unsigned long long protectedSquares, bool asWhite )
 
         // Pawn
         // Captures are reflections, so can index 'capture' potential pawn is a viable test
-        captureMask = Bitboard::getPawnCaptures( index, !asWhite );
+        captureMask = Bitboard::getPawnCaptures( index, !isWhite );
 
         if ( captureMask & enemy.pawnMask() )
         {
@@ -764,6 +1194,27 @@ void Board::validateCastlingRights()
     } );
 }
 
+void Board::initializeKeys()
+{
+    hashKey = Zobrist::getCastlingKey( castlingRights ) ^ Zobrist::getEnPassantKey( enPassantIndex );
+    pawnKey = 0;
+
+    if ( !Piece::isWhite( activeColor ) )
+    {
+        hashKey ^= Zobrist::getBlackToMoveKey();
+    }
+
+    for ( unsigned short index = 0; index < 64; index++ )
+    {
+        hashKey ^= Zobrist::getPieceKey( pieceAt( index ), index );
+
+        if ( Piece::isPawn( pieceAt( index ) ) )
+        {
+            pawnKey ^= Zobrist::getPieceKey( pieceAt( index ), index );
+        }
+    }
+}
+
 bool Board::isTerminal( short* result )
 {
     std::vector<Move> moves = getMoves();
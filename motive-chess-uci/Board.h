@@ -1,15 +1,28 @@
 #pragma once
 
 #include <array>
+#include <type_traits>
 
 #include "CastlingRights.h"
 #include "Fen.h"
 #include "Move.h"
 #include "Piece.h"
 #include "Utilities.h"
+#include "Zobrist.h"
 
 class Board
 {
+public:
+    /// <summary>
+    /// Which pseudo legal moves to generate. Captures include all promotions and quiets include castling
+    /// </summary>
+    enum class MoveGeneration
+    {
+        ALL,
+        CAPTURES,
+        QUIETS
+    };
+
 private:
     // Square indices for the first and last ranks
     inline static const unsigned short A1 = 0;
@@ -55,8 +68,25 @@ private:
     unsigned short halfmoveClock;
     unsigned short fullmoveNumber;
 
+    // Hash of the whole position, and of the pawns only, maintained as pieces are placed and removed
+    unsigned long long hashKey;
+    unsigned long long pawnKey;
+
     inline void setPiece( const unsigned short index, const unsigned char piece )
     {
+        // The empty square's key is zero, so this is safe whatever is leaving and arriving
+        hashKey ^= Zobrist::getPieceKey( pieces[ index ], index ) ^ Zobrist::getPieceKey( piece, index );
+
+        // Keep the pawn key in step with any pawn leaving or arriving on this square
+        if ( Piece::isPawn( pieces[ index ] ) )
+        {
+            pawnKey ^= Zobrist::getPieceKey( pieces[ index ], index );
+        }
+        if ( Piece::isPawn( piece ) )
+        {
+            pawnKey ^= Zobrist::getPieceKey( piece, index );
+        }
+
         pieces[ index ] = piece;
     }
 
@@ -112,8 +142,53 @@ private:
 
     void validateCastlingRights();
 
+    /// <summary>
+    /// Calculate the hash keys from scratch. Thereafter, they are maintained incrementally
+    /// </summary>
+    void initializeKeys();
+
     bool failsCheckTests( unsigned long long protectedSquares, bool asWhite ) const;
 
+    /// <summary>
+    /// Whether any of the squares are attacked by the given color. Specialised by color so that the
+    /// tests carry no color branches
+    /// </summary>
+    template<bool isWhite>
+    bool attackedBy( unsigned long long protectedSquares ) const;
+
+    /// <summary>
+    /// Generate pseudo legal moves for the given color, which must be the active color. Specialised by
+    /// color so that the generator carries no color branches
+    /// </summary>
+    template<bool isWhite>
+    void generate( MoveGeneration generation, std::vector<Move>& moves );
+
+    /// <summary>
+    /// Legality from the position as it stands, using the checkers of the king and any pin on the moving piece
+    /// </summary>
+    template<bool isWhite>
+    bool isLegal( const Move& move );
+
+    /// <summary>
+    /// The squares of the given color's pieces that attack a square, read straight from the board
+    /// </summary>
+    /// <param name="index">the square attacked</param>
+    /// <param name="ignore">a square to treat as empty, such as that of a king moving away along a line, or offboard</param>
+    /// <returns>a bitboard of the attackers</returns>
+    template<bool byWhite>
+    unsigned long long attackersOf( unsigned short index, unsigned short ignore ) const;
+
+    /// <summary>
+    /// The index step from one square towards another on the same rank, file or diagonal
+    /// </summary>
+    /// <returns>the step, or zero if the squares are not in line</returns>
+    static short lineStep( unsigned short from, unsigned short to );
+
+    /// <summary>
+    /// Whether the squares between two squares on the same line are all empty
+    /// </summary>
+    bool isPathClear( unsigned short from, unsigned short to ) const;
+
     unsigned long long movesInARay( unsigned long long possibleMoves,
                                     unsigned long long rayMask,
                                     unsigned long long ownPieces,
@@ -122,6 +197,15 @@ private:
                                     unsigned long long belowMask,
                                     bool supportsCaptures = true ) const;
 
+    /// <summary>
+    /// Squares attacked by a slider, up to and including the first piece in each direction, whatever its color
+    /// </summary>
+    /// <param name="index">the square the slider is on</param>
+    /// <param name="occupancy">all pieces on the board</param>
+    /// <returns>the attacked squares</returns>
+    unsigned long long bishopAttacks( unsigned short index, unsigned long long occupancy ) const;
+    unsigned long long rookAttacks( unsigned short index, unsigned long long occupancy ) const;
+
     unsigned long long makePieceBitboard( unsigned char piece ) const;
 
     /// <summary>
@@ -196,6 +280,8 @@ public:
         fullmoveNumber( 1 )
     {
         std::fill( pieces.begin(), pieces.end(), Piece::emptyPiece() );
+
+        initializeKeys();
     };
 
     Board( std::array< unsigned char, 64 > pieces,
@@ -212,28 +298,7 @@ public:
         fullmoveNumber( fullmoveNumber )
     {
         validateCastlingRights();
-    };
-
-    Board( Board& board ) :
-        pieces( board.pieces ),
-        activeColor( board.activeColor ),
-        castlingRights( board.castlingRights ),
-        enPassantIndex( board.enPassantIndex ),
-        halfmoveClock( board.halfmoveClock ),
-        fullmoveNumber( board.fullmoveNumber )
-    {
-        // Plain copy, nothing to do
-    };
-
-    Board( const Board& board ) :
-        pieces( board.pieces ),
-        activeColor( board.activeColor ),
-        castlingRights( board.castlingRights ),
-        enPassantIndex( board.enPassantIndex ),
-        halfmoveClock( board.halfmoveClock ),
-        fullmoveNumber( board.fullmoveNumber )
-    {
-        // Plain copy, nothing to do
+        initializeKeys();
     };
 
     Board( const Fen& fen ) :
@@ -245,11 +310,7 @@ public:
         fullmoveNumber( fen.fullmoveNumber )
     {
         validateCastlingRights();
-    }
-
-    virtual ~Board()
-    {
-        // Do nothing
+        initializeKeys();
     }
 
     bool operator == ( const Board& board ) const
@@ -290,6 +351,39 @@ public:
 
     std::vector<Move> getMoves();
 
+    /// <summary>
+    /// Generate moves that follow the piece movement rules, without testing whether they leave the king in check
+    /// </summary>
+    /// <param name="generation">which moves to generate</param>
+    /// <param name="moves">receives the moves</param>
+    void getPseudoLegalMoves( MoveGeneration generation, std::vector<Move>& moves );
+
+    /// <summary>
+    /// Whether a move, known to be pseudo legal, does not leave the mover in check
+    /// </summary>
+    bool isLegal( const Move& move );
+
+    /// <summary>
+    /// Whether a move from somewhere else (such as a hash table or another node) could have been generated
+    /// for this position, including its flags, but without testing whether it leaves the mover in check
+    /// </summary>
+    bool isPseudoLegal( const Move& move ) const;
+
+    /// <summary>
+    /// Fill in the flags of a move known only by its squares and any promotion piece, as when read from UCI
+    /// </summary>
+    /// <param name="move">the move</param>
+    /// <returns>the move as the generator would have made it, or the null move if it isn't pseudo legal here</returns>
+    Move completeMove( const Move& move ) const;
+
+    bool isInCheck() const;
+
+    /// <summary>
+    /// The squares of the pieces giving check to the side to move
+    /// </summary>
+    /// <returns>a bitboard of the checkers, empty if not in check</returns>
+    unsigned long long getCheckers() const;
+
     /// <summary>
     /// Looks for terminal positions and reports back with details as applied to the current board
     /// </summary>
@@ -302,6 +396,21 @@ public:
         return activeColor;
     }
 
+    inline unsigned short getHalfmoveClock() const
+    {
+        return halfmoveClock;
+    }
+
+    inline unsigned long long getHashKey() const
+    {
+        return hashKey;
+    }
+
+    inline unsigned long long getPawnKey() const
+    {
+        return pawnKey;
+    }
+
     /// <summary>
     /// Convenience method to print the current board to the log
     /// </summary>
@@ -312,6 +421,12 @@ public:
         return *this;
     }
 
+    friend class AccumulatorStack;
     friend class Evaluation;
+    friend class MovePicker;
 };
 
+// Boards are copied for every move made (copy-make), so the copy must stay a plain memory copy, and a small one:
+// 64 squares, the side to move, castling rights, en passant square, clocks and the two hash keys
+static_assert( std::is_trivially_copyable_v<Board> && std::is_standard_layout_v<Board> );
+static_assert( sizeof( Board ) == 88 );
@@ -7,6 +7,7 @@
 #include <vector>
 
 #include "CopyProtection.h"
+#include "Move.h"
 #include "Option.h"
 #include "Registration.h"
 
@@ -42,14 +43,22 @@ public:
         stream << "id author " << author << std::endl;
     }
 
-    void bestmove( std::string bestmove )
+    void bestmove( const Move& bestmove )
     {
-        stream << "bestmove " << bestmove << std::endl;
+        char text[ Move::UCI_BUFFER_SIZE ];
+        bestmove.toUci( text );
+
+        stream << "bestmove " << text << std::endl;
     }
 
-    void bestmove( std::string bestmove, std::string ponder )
+    void bestmove( const Move& bestmove, const Move& ponder )
     {
-        stream << "bestmove " << bestmove << " ponder " << ponder << std::endl;
+        char bestText[ Move::UCI_BUFFER_SIZE ];
+        char ponderText[ Move::UCI_BUFFER_SIZE ];
+        bestmove.toUci( bestText );
+        ponder.toUci( ponderText );
+
+        stream << "bestmove " << bestText << " ponder " << ponderText << std::endl;
     }
 
     void copyprotection( CopyProtection::Status status )
@@ -111,10 +120,20 @@ public:
 
     void option( std::string name, bool def )
     {
-        option( name, Option::Type::CHECK, def ? "true" : "false", "", "", new std::string[0]);
+        option( name, Option::Type::CHECK, def ? "true" : "false", "", "", std::vector<std::string>() );
+    }
+
+    void option( std::string name, size_t def, size_t min, size_t max )
+    {
+        option( name, Option::Type::SPIN, std::to_string( def ), std::to_string( min ), std::to_string( max ), std::vector<std::string>() );
+    }
+
+    void option( std::string name, std::string def, const std::vector<std::string>& vars )
+    {
+        option( name, Option::Type::COMBO, def, "", "", vars );
     }
 
-    void option( std::string name, Option::Type type, std::string def, std::string min, std::string max, std::string vars[] )
+    void option( std::string name, Option::Type type, std::string def, std::string min, std::string max, const std::vector<std::string>& vars )
     {
         std::stringstream details;
 
@@ -130,9 +149,9 @@ public:
 
             case Option::Type::COMBO:
                 details << "combo default " << def;
-                for ( int loop = 0; loop < sizeof( vars ); loop++ )
+                for ( const std::string& var : vars )
                 {
-                    details << " var " << vars[ loop ];
+                    details << " var " << var;
                 }
                 break;
 
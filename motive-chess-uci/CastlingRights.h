@@ -3,6 +3,7 @@
 #include <array>
 #include <sstream>
 #include <string>
+#include <type_traits>
 
 class CastlingRights
 {
@@ -25,23 +26,6 @@ public:
 
     }
 
-    CastlingRights( CastlingRights& copy ) :
-        rights( copy.rights )
-    {
-
-    }
-
-    CastlingRights( const CastlingRights& copy ) :
-        rights( copy.rights )
-    {
-
-    }
-
-    virtual ~CastlingRights()
-    {
-
-    }
-
     bool operator == ( const CastlingRights& other ) const
     {
         return rights == other.rights;
@@ -126,23 +110,34 @@ public:
         rights &= ~BLACK_QUEENSIDE;
     }
 
-    inline bool canWhiteCastleKingside()
+    /// <summary>
+    /// The raw rights bits, 0-15, for use as a table index
+    /// </summary>
+    inline unsigned char getRights() const
+    {
+        return rights;
+    }
+
+    inline bool canWhiteCastleKingside() const
     {
         return rights & WHITE_KINGSIDE;
     }
 
-    inline bool canWhiteCastleQueenside()
+    inline bool canWhiteCastleQueenside() const
     {
         return rights & WHITE_QUEENSIDE;
     }
 
-    inline bool canBlackCastleKingside()
+    inline bool canBlackCastleKingside() const
     {
         return rights & BLACK_KINGSIDE;
     }
 
-    inline bool canBlackCastleQueenside()
+    inline bool canBlackCastleQueenside() const
     {
         return rights & BLACK_QUEENSIDE;
     }
 };
+
+static_assert( sizeof( CastlingRights ) == 1 );
+static_assert( std::is_trivially_copyable_v<CastlingRights> && std::is_standard_layout_v<CastlingRights> );
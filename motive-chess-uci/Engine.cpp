@@ -1,7 +1,11 @@
 #include <algorithm>
+#include <atomic>
+#include <bit>
+#include <chrono>
 #include <cstdlib>
 #include <ctime>
 #include <fstream>
+#include <iomanip>
 #include <thread>
 #include <vector>
 
@@ -12,6 +16,8 @@
 #include "GameContext.h"
 #include "Log.h"
 #include "Move.h"
+#include "Network.h"
+#include "SearchTrace.h"
 #include "Utilities.h"
 
 #define UCI_DEBUG Engine::UciLogger( *this, Log::Level::DEBUG ).log( "" )
@@ -47,7 +53,7 @@ void Engine::uciCommand()
     broadcaster.registration( Registration::Status::OK );
 }
 
-void Engine::debugCommand( std::vector<std::string>& arguments )
+void Engine::debugCommand( std::vector<std::string_view>& arguments )
 {
     UCI_DEBUG << "Received debug";
 
@@ -82,7 +88,7 @@ void Engine::isreadyCommand()
     broadcaster.readyok();
 }
 
-void Engine::setoptionCommand( std::vector<std::string>& arguments )
+void Engine::setoptionCommand( std::vector<std::string_view>& arguments )
 {
     UCI_DEBUG << "Received setoption";
 
@@ -93,7 +99,7 @@ void Engine::setoptionCommand( std::vector<std::string>& arguments )
     bool isValue = false;
 
     // Expect either (name and/or code), or (later), assuming that's what the UCI spec intends
-    for ( std::vector<std::string>::iterator it = arguments.begin(); it != arguments.end(); it++ )
+    for ( std::vector<std::string_view>::iterator it = arguments.begin(); it != arguments.end(); it++ )
     {
         if ( *it == "name" )
         {
@@ -137,7 +143,7 @@ void Engine::setoptionCommand( std::vector<std::string>& arguments )
     }
 }
 
-void Engine::registerCommand( std::vector<std::string>& arguments )
+void Engine::registerCommand( std::vector<std::string_view>& arguments )
 {
     UCI_DEBUG << "Received register";
 
@@ -149,7 +155,7 @@ void Engine::registerCommand( std::vector<std::string>& arguments )
     bool isCode = false;
 
     // Expect either (name and/or code), or (later), assuming that's what the UCI spec intends
-    for ( std::vector<std::string>::iterator it = arguments.begin(); it != arguments.end(); it++ )
+    for ( std::vector<std::string_view>::iterator it = arguments.begin(); it != arguments.end(); it++ )
     {
         if ( *it == "name" )
         {
@@ -215,6 +221,7 @@ void Engine::ucinewgameCommand()
 
         Log::Trace << "Releasing game context" << std::endl;
         releaseGameContext();
+        moveOrdering.clear();
     }
     else
     {
@@ -222,7 +229,7 @@ void Engine::ucinewgameCommand()
     }
 }
 
-void Engine::positionCommand( std::vector<std::string>& arguments )
+void Engine::positionCommand( std::vector<std::string_view>& arguments )
 {
     UCI_DEBUG << "Received position";
 
@@ -230,15 +237,16 @@ void Engine::positionCommand( std::vector<std::string>& arguments )
     {
         ucinewgameExpected = false;
 
-        // No ucinewgame, so we need to stop and reinitialise
-        Log::Trace << "Preparing for new game" << std::endl;
+        // No ucinewgame, so this may be the same game carried on - the position will tell
+        Log::Trace << "Preparing for next position" << std::endl;
         stopImpl();
-        releaseGameContext();
     }
 
-    std::string fen;
-    std::vector<std::string> moves;
-    for ( std::vector<std::string>::iterator it = arguments.begin(); it != arguments.end(); )
+    // Refers to the starting position, or the FEN text, which is only gathered up if given
+    std::string_view fen;
+    std::string fenText;
+    positionMoves.clear();
+    for ( std::vector<std::string_view>::iterator it = arguments.begin(); it != arguments.end(); )
     {
         if ( *it == "startpos" )
         {
@@ -248,9 +256,8 @@ void Engine::positionCommand( std::vector<std::string>& arguments )
         else if ( *it == "fen" )
         {
             // New FEN string, so clear moves as a safety measure
-            moves.clear();
-
-            std::stringstream stream;
+            positionMoves.clear();
+            fenText.clear();
 
             it++;
             for ( ; it != arguments.end(); it++ )
@@ -260,25 +267,25 @@ void Engine::positionCommand( std::vector<std::string>& arguments )
                     break;
                 }
 
-                if ( !stream.str().empty() )
+                if ( !fenText.empty() )
                 {
-                    stream << " ";
+                    fenText += " ";
                 }
 
-                stream << *it;
+                fenText += *it;
             }
 
-            fen = stream.str();
+            fen = fenText;
         }
         else if ( *it == "moves" )
         {
             // Reset collection as a safety measure
-            moves.clear();
+            positionMoves.clear();
 
             it++;
             for ( ; it != arguments.end(); it++ )
             {
-                moves.push_back( *it );
+                positionMoves.push_back( Move::parseUci( *it ) );
             }
         }
         else
@@ -291,9 +298,9 @@ void Engine::positionCommand( std::vector<std::string>& arguments )
 
     if ( !fen.empty() )
     {
-        Log::Debug << "Position with FEN [" << fen << "] and " << moves.size() << " moves" << std::endl;
+        Log::Debug << "Position with FEN [" << fen << "] and " << positionMoves.size() << " moves" << std::endl;
 
-        positionImpl( fen, moves );
+        positionImpl( fen, positionMoves );
     }
     else
     {
@@ -301,7 +308,7 @@ void Engine::positionCommand( std::vector<std::string>& arguments )
     }
 }
 
-void Engine::goCommand( std::vector<std::string>& arguments )
+void Engine::goCommand( std::vector<std::string_view>& arguments )
 {
     UCI_DEBUG << "Received go";
 
@@ -320,22 +327,26 @@ void Engine::goCommand( std::vector<std::string>& arguments )
 
     bool parseError = false;
 
-    for ( std::vector<std::string>::iterator it = arguments.begin(); it != arguments.end(); )
+    for ( std::vector<std::string_view>::iterator it = arguments.begin(); it != arguments.end(); )
     {
         if ( *it == "searchmoves" )
         {
-            std::vector<std::string> directives = getGoDirectives();
-
             // Capture the next few strings as moves unless they are other 'go' keywords
             for ( ; ++it != arguments.end(); )
             {
-                if ( std::find( directives.begin(), directives.end(), *it ) != directives.end() )
+                if ( isGoDirective( *it ) )
                 {
                     // Recognised keyword, break out of this loop and process below
                     break;
                 }
 
-                searchMoves.push_back( Move::fromString( *it ) );
+                searchMoves.push_back( Move::parseUci( *it ) );
+            }
+
+            // The move list may run to the end of the command
+            if ( it == arguments.end() )
+            {
+                break;
             }
         }
         
@@ -349,7 +360,7 @@ void Engine::goCommand( std::vector<std::string>& arguments )
             it++;
             if ( it != arguments.end() )
             {
-                wtime = stoi( *it );
+                wtime = Utilities::toInt( *it );
             }
             else
             {
@@ -361,7 +372,7 @@ void Engine::goCommand( std::vector<std::string>& arguments )
             it++;
             if ( it != arguments.end() )
             {
-                btime = stoi( *it );
+                btime = Utilities::toInt( *it );
             }
             else
             {
@@ -373,7 +384,7 @@ void Engine::goCommand( std::vector<std::string>& arguments )
             it++;
             if ( it != arguments.end() )
             {
-                winc = stoi( *it );
+                winc = Utilities::toInt( *it );
             }
             else
             {
@@ -385,7 +396,7 @@ void Engine::goCommand( std::vector<std::string>& arguments )
             it++;
             if ( it != arguments.end() )
             {
-                binc = stoi( *it );
+                binc = Utilities::toInt( *it );
             }
             else
             {
@@ -397,7 +408,7 @@ void Engine::goCommand( std::vector<std::string>& arguments )
             it++;
             if ( it != arguments.end() )
             {
-                movestogo = stoi( *it );
+                movestogo = Utilities::toInt( *it );
             }
             else
             {
@@ -409,7 +420,7 @@ void Engine::goCommand( std::vector<std::string>& arguments )
             it++;
             if ( it != arguments.end() )
             {
-                depth = stoi( *it );
+                depth = Utilities::toInt( *it );
             }
             else
             {
@@ -421,7 +432,7 @@ void Engine::goCommand( std::vector<std::string>& arguments )
             it++;
             if ( it != arguments.end() )
             {
-                nodes = stoi( *it );
+                nodes = Utilities::toInt( *it );
             }
             else
             {
@@ -433,7 +444,7 @@ void Engine::goCommand( std::vector<std::string>& arguments )
             it++;
             if ( it != arguments.end() )
             {
-                mate = stoi( *it );
+                mate = Utilities::toInt( *it );
             }
             else
             {
@@ -445,7 +456,7 @@ void Engine::goCommand( std::vector<std::string>& arguments )
             it++;
             if ( it != arguments.end() )
             {
-                movetime = stoi( *it );
+                movetime = Utilities::toInt( *it );
             }
             else
             {
@@ -482,6 +493,8 @@ void Engine::stopCommand()
 {
     UCI_DEBUG << "Received stop";
 
+    SearchTrace::instant( "stop" );
+
     stopImpl( ThinkingOutcome::BROADCAST );
 
     // TODO do something now we've stopped - bestmove and possibly ponder - currently we are doing this elsewhere
@@ -512,10 +525,47 @@ bool Engine::quitCommand()
 
 // Special perft command
 
-void Engine::perftCommand( std::vector<std::string>& arguments, bool expectsDepth )
+void Engine::perftCommand( std::vector<std::string>& arguments )
 {
     UCI_DEBUG << "Received perft";
 
+    // Count on the worker thread, leaving this one free for stop, isready and quit
+    stopImpl();
+
+    perftRunning = true;
+    continueThinking = true;
+    thinkingThread = new std::thread( &Engine::perfting, this, arguments );
+
+    Log::Trace << "Thread " << thinkingThread->get_id() << " running" << std::endl;
+}
+
+void Engine::waitForPerft()
+{
+    if ( perftRunning )
+    {
+        joinImpl();
+    }
+}
+
+void Engine::perfting( Engine* engine, std::vector<std::string> arguments )
+{
+    SearchTrace::nameThread( "perft" );
+    SearchTrace::Scope scope( "perft" );
+
+    engine->perftStart = std::chrono::steady_clock::now();
+    engine->perftNodes.store( 0, std::memory_order_relaxed );
+    engine->perftNextProgress.store( ( engine->perftStart + PERFT_PROGRESS_INTERVAL ).time_since_epoch().count(), std::memory_order_relaxed );
+
+    engine->perftRun( arguments, true );
+
+    if ( !engine->continueThinking )
+    {
+        Engine::UciLogger( *engine, Log::Level::INFO ).log( "" ) << "Perft stopped";
+    }
+}
+
+void Engine::perftRun( std::vector<std::string>& arguments, bool expectsDepth )
+{
     // Command line syntax:
     //  perft [depth] <fen> <expected>
     //      depth is an integer search depth in half-moves
@@ -527,12 +577,135 @@ void Engine::perftCommand( std::vector<std::string>& arguments, bool expectsDept
     // e.g. 
     //      perft 1 4k3/8/8/8/8/8/8/4K2R w K - 0 1 ;D1 15 ;D2 66 ;D3 1197 ;D4 7059 ;D5 133987 ;D6 764643
     //      perft 1 4k3/8/8/8/8/8/8/4K2R w K -,15,66,1197,7059,133987,764643
+    //
+    // or, to count each line of an EPD file, optionally recording the results as JSON (.json) or CSV (anything else):
+    //  perft file <filename> [report <filename>]
+    //
+    // or, to count every line of an EPD file at once, spread across threads, biggest counts first:
+    //  perft suite <filename> [threads <count>] [report <filename>]
+    //
+    // or, to break the leaves at a depth down by captures, en passant, castles, promotions, checks and checkmates:
+    //  perft stats <depth> [fen]
+
+    if ( !arguments.empty() && ( arguments[ 0 ] == "file" || arguments[ 0 ] == "suite" ) )
+    {
+        bool isSuite = arguments[ 0 ] == "suite";
+
+        std::vector<std::string>::iterator it = arguments.begin() + 1;
+        if ( it == arguments.end() )
+        {
+            Log::Error << "Missing filename" << std::endl;
+            return;
+        }
+
+        std::string filename = stripQuotes( *it++ );
+        if ( filename.empty() )
+        {
+            Log::Error << "Empty filename" << std::endl;
+            return;
+        }
+
+        // Options, each followed by its value
+        std::string reportFilename;
+        unsigned int threads = std::max( 1u, std::thread::hardware_concurrency() );
+        for ( ; it != arguments.end(); it++ )
+        {
+            if ( it + 1 == arguments.end() )
+            {
+                Log::Error << "Missing value for " << *it << std::endl;
+                return;
+            }
+
+            if ( *it == "report" )
+            {
+                reportFilename = stripQuotes( *++it );
+            }
+            else if ( *it == "threads" && isSuite )
+            {
+                threads = std::max( 1, Utilities::toInt( *++it ) );
+            }
+            else
+            {
+                Log::Error << "Unexpected argument " << *it << std::endl;
+                return;
+            }
+        }
+
+        PerftReport* report = reportFilename.empty() ? nullptr : new PerftReport( reportFilename );
+
+        if ( isSuite )
+        {
+            Log::Info << "Starting perft suite from file " << filename << " on " << threads << " thread(s)" << std::endl;
+
+            perftSuite( filename, threads, report );
+        }
+        else
+        {
+            Log::Info << "Starting perft run from file " << filename << std::endl;
+
+            perftFile( filename, report );
+        }
+
+        // Closing the report completes it
+        delete report;
+
+        return;
+    }
+
+    bool withStatistics = !arguments.empty() && arguments[ 0 ] == "stats";
+    if ( withStatistics )
+    {
+        arguments.erase( arguments.begin() );
+    }
 
     int depth = 0;
     std::string fenString;
-    std::stringstream stream;
     std::vector<std::pair<unsigned int, unsigned int>> expectedResults;
 
+    if ( !parsePerft( arguments, expectsDepth || withStatistics, depth, fenString, expectedResults ) )
+    {
+        UCI_ERROR << "Missing depth in perft command";
+        return;
+    }
+
+    Fen fen = Fen::fromPosition( fenString );
+    Board board( fen );
+
+    if ( withStatistics )
+    {
+        Log::Info << "Starting perft stats run at depth " << depth << " with " << fenString << std::endl;
+
+        perftStats( board, fenString, depth );
+        return;
+    }
+
+    if ( expectedResults.empty() )
+    {
+        Log::Info << "Starting perft run at depth " << depth << " with " << fenString << std::endl;
+        
+        perftDepth( board, fenString, depth );
+    }
+    else
+    {
+        Log::Info << "Starting perft run with " << fenString << std::endl;
+
+        Log::Trace( [&] ( const Log::Logger& logger )
+        {
+            logger << "Expected results:" << std::endl;
+            for ( std::vector<std::pair<unsigned int, unsigned int>>::iterator it = expectedResults.begin(); it != expectedResults.end(); it++ )
+            {
+                logger << "  Depth " << ( *it ).first << ". Count " << ( *it ).second << std::endl;
+            }
+        } );
+
+        perftRange( board, fenString, expectedResults );
+    }
+}
+
+bool Engine::parsePerft( std::vector<std::string>& arguments, bool expectsDepth, int& depth, std::string& fenString, std::vector<std::pair<unsigned int, unsigned int>>& expectedResults )
+{
+    std::stringstream stream;
+
     // Rewrite 'arguments' to split anything containing a ';' or ',' because these are used
     // to add perft hints to the FEN string and need to be parsed out here
 
@@ -576,203 +749,204 @@ void Engine::perftCommand( std::vector<std::string>& arguments, bool expectsDept
     }
 
     std::vector<std::string>::iterator it = arguments.begin();
-    if ( it != arguments.end() )
+    if ( it == arguments.end() )
     {
-        if ( *it == "file" )
-        {
-            it++;
-
-            if ( it == arguments.end() )
-            {
-                Log::Error << "Missing filename" << std::endl;
-            }
-            else
-            {
-                std::string filename = *it;
-
-                // Strip quotes - added when pasting a file path containing spaces
-                while ( filename[ 0 ] == '"' )
-                {
-                    filename = filename.substr( 1 );
-                }
-                while ( filename[ filename.length() - 1 ] == '"' )
-                {
-                    filename = filename.substr( 0, filename.length() - 1 );
-                }
-
-                if ( filename.empty() )
-                {
-                    Log::Error << "Empty filename" << std::endl;
-                    return;
-                }
-
-                Log::Info << "Starting perft run from file " << filename << std::endl;
-
-                perftFile( filename );
-            }
+        return false;
+    }
 
-            return;
-        }
+    // Read the depth (if mandatory)
+    if ( expectsDepth )
+    {
+        depth = stoi( *( it++ ) );
+    }
 
-        // Read the depth (if mandatory)
-        if ( expectsDepth )
+    // Read the FEN string (treat as optional, but expected if there is anything later)
+    for ( ; it != arguments.end(); it++ )
+    {
+        if ( ( *it )[ 0 ] == ';' || ( *it )[ 0 ] == ',' )
         {
-            depth = stoi( *( it++ ) );
+            break;
         }
 
-        // Read the FEN string (treat as optional, but expected if there is anything later)
-        for ( ; it != arguments.end(); it++ )
+        if ( !stream.str().empty() )
         {
-            if ( ( *it )[ 0 ] == ';' || ( *it )[ 0 ] == ',' )
-            {
-                break;
-            }
-
-            if ( !stream.str().empty() )
-            {
-                stream << " ";
-            }
-
-            stream << *it;
+            stream << " ";
         }
 
-        fenString = stream.str();
+        stream << *it;
+    }
+
+    fenString = stream.str();
 
-        unsigned int expectedDepth = 0;
-        unsigned int expectedCount = 0;
+    unsigned int expectedDepth = 0;
+    unsigned int expectedCount = 0;
 
-        for ( ; it != arguments.end(); it++ )
+    for ( ; it != arguments.end(); it++ )
+    {
+        switch ( ( *it )[ 0 ] )
         {
-            switch ( ( *it )[ 0 ] )
-            {
-                case ';':// Expected structure: "<FEN>;D1 20; D2 400; D3 8902;..."
-                    if ( ( *it ).size() > 2 )
+            case ';':// Expected structure: "<FEN>;D1 20; D2 400; D3 8902;..."
+                if ( ( *it ).size() > 2 )
+                {
+                    if ( ( *it )[ 1 ] == 'D' )
                     {
-                        if ( ( *it )[ 1 ] == 'D' )
-                        {
-                            expectedDepth = stoi( (*it++).substr( 2 ) );
-                            expectedCount = stoi( *it );
-
-                            Log::Trace << "Noting expected result for depth " << expectedDepth << " of " << expectedCount << std::endl;
-                            expectedResults.push_back( std::pair<unsigned int, unsigned int>( expectedDepth, expectedCount ) );
-                        }
-                        else
-                        {
-                            Log::Error << "Unexpected result " << *it << std::endl;
-                        }
+                        expectedDepth = stoi( (*it++).substr( 2 ) );
+                        expectedCount = stoi( *it );
+
+                        Log::Trace << "Noting expected result for depth " << expectedDepth << " of " << expectedCount << std::endl;
+                        expectedResults.push_back( std::pair<unsigned int, unsigned int>( expectedDepth, expectedCount ) );
                     }
                     else
                     {
-                        Log::Error << "Unexpected value " << *it << std::endl;
+                        Log::Error << "Unexpected result " << *it << std::endl;
                     }
-                    break;
+                }
+                else
+                {
+                    Log::Error << "Unexpected value " << *it << std::endl;
+                }
+                break;
 
-                case ',': // Expected structure: "<FEN>,20,400,8902,..."
-                    expectedCount = stoi( ( *it ).substr( 1 ) );
-                    expectedDepth++;
+            case ',': // Expected structure: "<FEN>,20,400,8902,..."
+                expectedCount = stoi( ( *it ).substr( 1 ) );
+                expectedDepth++;
 
-                    Log::Trace << "Noting expected result for depth " << expectedDepth << " of " << expectedCount << std::endl;
-                    expectedResults.push_back( std::pair<unsigned int, unsigned int>( expectedDepth, expectedCount ) );
-                    break;
+                Log::Trace << "Noting expected result for depth " << expectedDepth << " of " << expectedCount << std::endl;
+                expectedResults.push_back( std::pair<unsigned int, unsigned int>( expectedDepth, expectedCount ) );
+                break;
 
-                default:
-                    Log::Error << "Unexpected argument" << *it << std::endl;
-                    break;
-            }
+            default:
+                Log::Error << "Unexpected argument" << *it << std::endl;
+                break;
         }
+    }
 
-        if ( fenString.empty() )
-        {
-            Log::Debug << "No FEN string specified; using default" << std::endl;
+    if ( fenString.empty() )
+    {
+        Log::Debug << "No FEN string specified; using default" << std::endl;
 
-            fenString = Fen::startingPosition;
-        }
+        fenString = Fen::startingPosition;
+    }
 
-        Fen fen = Fen::fromPosition( fenString );
-        Board board( fen );
+    return true;
+}
 
+// Helper methods
+std::string Engine::stripQuotes( const std::string& text )
+{
+    // Added when pasting a file path containing spaces
+    size_t first = text.find_first_not_of( '"' );
+    if ( first == std::string::npos )
+    {
+        return std::string();
+    }
 
-        if ( expectedResults.empty() )
-        {
-            Log::Info << "Starting perft run at depth " << depth << " with " << fenString << std::endl;
-            
-            perftDepth( board, depth );
-        }
-        else
-        {
-            Log::Info << "Starting perft run with " << fenString << std::endl;
+    return text.substr( first, text.find_last_not_of( '"' ) - first + 1 );
+}
 
-            Log::Trace( [&] ( const Log::Logger& logger )
-            {
-                logger << "Expected results:" << std::endl;
-                for ( std::vector<std::pair<unsigned int, unsigned int>>::iterator it = expectedResults.begin(); it != expectedResults.end(); it++ )
-                {
-                    logger << "  Depth " << ( *it ).first << ". Count " << ( *it ).second << std::endl;
-                }
-            } );
+void Engine::perftDepth( Board& board, const std::string& fenString, int depth )
+{
+    // Wall time, rather than the processor time of this thread
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    unsigned long nodes = perftImpl( depth, board, true );
+    std::chrono::steady_clock::duration elapsed = std::chrono::steady_clock::now() - start;
 
-            perftRange( board, expectedResults );
-        }
+    // A stopped count is only part of one
+    if ( !continueThinking )
+    {
+        return;
     }
-    else
+
+    double seconds = std::chrono::duration<double>( elapsed ).count();
+
+    // This will give 0 if elapsed is close to zero - but not sure what to do with that other than continue
+    unsigned long longNPS = seconds == 0 ? 0 : std::lround( nodes / seconds );
+
+    Log::Info << "Total node count at depth " << depth << " is " << nodes << ". Time " << seconds << "s (" << longNPS << " nps)" << std::endl;
+
+    if ( perftReport != nullptr )
     {
-        UCI_ERROR << "Missing depth in perft command";
+        perftReport->add( fenString, depth, PerftReport::NO_EXPECTATION, nodes, elapsed );
     }
 }
 
-// Helper methods
-void Engine::perftDepth( Board& board, int depth )
+void Engine::perftStats( Board& board, const std::string& fenString, int depth )
 {
-    clock_t start = clock();
-    unsigned long nodes = perftImpl( depth, board, true );
-    clock_t end = clock();
+    PerftStatistics statistics;
 
-    float elapsed = static_cast<float>( end - start ) / CLOCKS_PER_SEC;
-    float nps = elapsed == 0 ? 0 : static_cast<float>( nodes ) / elapsed;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    unsigned long nodes = perftImpl<true>( depth, board, false, &statistics );
+    std::chrono::steady_clock::duration elapsed = std::chrono::steady_clock::now() - start;
 
-    // This will give 0 if elapsed is close to zero - but not sure what to do with that other than continue
-    unsigned long longNPS = std::lround( nps );
+    if ( !continueThinking )
+    {
+        return;
+    }
+
+    double seconds = std::chrono::duration<double>( elapsed ).count();
+
+    Log::Info << "Total node count at depth " << depth << " is " << nodes << ". Time " << seconds << "s" << std::endl;
+    Log::Info << "  Captures " << statistics.captures << ", en passant " << statistics.enPassantCaptures << ", castles " << statistics.castles
+              << ", promotions " << statistics.promotions << std::endl;
+    Log::Info << "  Checks " << statistics.checks << ", discovered " << statistics.discoveredChecks << ", double " << statistics.doubleChecks
+              << ", checkmates " << statistics.checkmates << std::endl;
 
-    Log::Info << "Total node count at depth " << depth << " is " << nodes << ". Time " << elapsed << "s (" << longNPS << " nps)" << std::endl;
+    if ( perftReport != nullptr )
+    {
+        perftReport->add( fenString, depth, PerftReport::NO_EXPECTATION, nodes, elapsed );
+    }
 }
 
-void Engine::perftRange( Board& board, std::vector<std::pair<unsigned int, unsigned int>> expectedResults )
+void Engine::perftRange( Board& board, const std::string& fenString, std::vector<std::pair<unsigned int, unsigned int>> expectedResults )
 {
     for ( std::vector<std::pair<unsigned int, unsigned int>>::iterator it = expectedResults.begin(); it != expectedResults.end(); it++ )
     {
         unsigned int depth = ( *it ).first;
         unsigned int count = ( *it ).second;
 
-        clock_t start = clock();
+        // Wall time, rather than the processor time of this thread
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
         unsigned long nodes = perftImpl( depth, board, true );
-        clock_t end = clock();
+        std::chrono::steady_clock::duration elapsed = std::chrono::steady_clock::now() - start;
+
+        if ( !continueThinking )
+        {
+            return;
+        }
 
-        float elapsed = static_cast<float>( end - start ) / CLOCKS_PER_SEC;
-        float nps = elapsed == 0 ? 0 : static_cast<float>( nodes ) / elapsed;
+        double seconds = std::chrono::duration<double>( elapsed ).count();
 
         // This will give 0 if elapsed is close to zero - but not sure what to do with that other than continue
-        unsigned long longNPS = std::lround( nps );
+        unsigned long longNPS = seconds == 0 ? 0 : std::lround( nodes / seconds );
 
         if ( nodes == count )
         {
-            Log::Info << "Total node count at depth " << depth << " is " << nodes << ". Time " << elapsed << "s (" << longNPS << " nps)" << std::endl;
+            Log::Info << "Total node count at depth " << depth << " is " << nodes << ". Time " << seconds << "s (" << longNPS << " nps)" << std::endl;
         }
         else
         {
-            Log::Error << "Total node count at depth " << depth << " is " << nodes << " but expected to be " << count << ". Time " << elapsed << "s (" << longNPS << " nps)" << std::endl;
+            Log::Error << "Total node count at depth " << depth << " is " << nodes << " but expected to be " << count << ". Time " << seconds << "s (" << longNPS << " nps)" << std::endl;
+            perftFailed = true;
+        }
+
+        if ( perftReport != nullptr )
+        {
+            perftReport->add( fenString, depth, count, nodes, elapsed );
         }
     }
 }
 
-void Engine::perftFile( std::string& filename )
+void Engine::perftFile( std::string& filename, PerftReport* report )
 {
+    perftReport = report;
+
     std::fstream file;
     file.open( filename, std::ios::in );
 
     if ( file.is_open() )
     {
         std::string line;
-        while ( std::getline( file, line ) )
+        while ( continueThinking && std::getline( file, line ) )
         {
             if ( line.empty() || line[ 0 ] == '#' )
             {
@@ -782,44 +956,308 @@ void Engine::perftFile( std::string& filename )
 
             Log::Trace << "Read: " << line << std::endl;
 
-            // Split the line into tokens
             std::vector<std::string> arguments;
-            std::string argument;
-            for ( std::string::iterator it = line.begin(); it != line.end(); it++ )
-            {
-                if ( *it == ' ' )
-                {
-                    if ( !argument.empty() )
-                    {
-                        arguments.push_back( argument );
-                        argument.clear();
-                    }
-                }
-                else
-                {
-                    argument.push_back( *it );
-                }
-            }
+            splitPerftLine( line, arguments );
 
+            // This just happens to do the processing we want, although we are not providing a depth this way
+            perftRun( arguments, false );
+        }
+    }
+    else
+    {
+        Log::Error << "Failed to read file " << filename << std::endl;
+    }
+
+    perftReport = nullptr;
+}
+
+void Engine::splitPerftLine( const std::string& line, std::vector<std::string>& arguments )
+{
+    std::string argument;
+    for ( std::string::const_iterator it = line.begin(); it != line.end(); it++ )
+    {
+        if ( *it == ' ' )
+        {
             if ( !argument.empty() )
             {
                 arguments.push_back( argument );
                 argument.clear();
             }
-
-            // This just happens to do the processing we want, although we are not providing a depth this way
-            perftCommand( arguments, false );
+        }
+        else
+        {
+            argument.push_back( *it );
         }
     }
-    else
+
+    if ( !argument.empty() )
+    {
+        arguments.push_back( argument );
+    }
+}
+
+// One count of a perft suite: a position to a depth
+class PerftJob
+{
+public:
+    size_t position;
+    unsigned int depth;
+    unsigned long long expected;
+
+    unsigned long long nodes;
+    std::chrono::steady_clock::duration elapsed;
+};
+
+void Engine::perftSuite( std::string& filename, unsigned int threads, PerftReport* report )
+{
+    std::fstream file;
+    file.open( filename, std::ios::in );
+
+    if ( !file.is_open() )
     {
         Log::Error << "Failed to read file " << filename << std::endl;
+        perftFailed = true;
+        return;
     }
+
+    // Load the whole file first, every expected count of every position becoming a job of its own
+    std::vector<std::string> fenStrings;
+    std::vector<Board> boards;
+    std::vector<PerftJob> jobs;
+
+    std::string line;
+    while ( std::getline( file, line ) )
+    {
+        if ( line.empty() || line[ 0 ] == '#' )
+        {
+            continue;
+        }
+
+        std::vector<std::string> arguments;
+        splitPerftLine( line, arguments );
+
+        int depth = 0;
+        std::string fenString;
+        std::vector<std::pair<unsigned int, unsigned int>> expectedResults;
+
+        if ( !parsePerft( arguments, false, depth, fenString, expectedResults ) || expectedResults.empty() )
+        {
+            Log::Warn << "Skipping line without expected counts: " << line << std::endl;
+            continue;
+        }
+
+        for ( const std::pair<unsigned int, unsigned int>& expected : expectedResults )
+        {
+            jobs.push_back( PerftJob { fenStrings.size(), expected.first, expected.second, 0, std::chrono::steady_clock::duration::zero() } );
+        }
+
+        fenStrings.push_back( fenString );
+        boards.push_back( Board( Fen::fromPosition( fenString ) ) );
+    }
+
+    // Biggest counts first, taking the expected count as the measure of the work, so that no thread is left
+    // with a long job to finish after the others have run out
+    std::vector<size_t> order( jobs.size() );
+    for ( size_t index = 0; index < order.size(); index++ )
+    {
+        order[ index ] = index;
+    }
+
+    std::stable_sort( order.begin(), order.end(), [&] ( size_t a, size_t b )
+    {
+        return jobs[ a ].expected > jobs[ b ].expected;
+    } );
+
+    std::atomic<size_t> next = 0;
+    auto worker = [&] ()
+    {
+        for ( size_t index = next++; index < order.size() && continueThinking; index = next++ )
+        {
+            PerftJob& job = jobs[ order[ index ] ];
+
+            std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+            job.nodes = perftImpl( job.depth, boards[ job.position ] );
+            job.elapsed = std::chrono::steady_clock::now() - start;
+        }
+    };
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+    std::vector<std::thread> pool;
+    for ( unsigned int thread = 0; thread < threads; thread++ )
+    {
+        pool.push_back( std::thread( worker ) );
+    }
+
+    for ( std::thread& thread : pool )
+    {
+        thread.join();
+    }
+
+    std::chrono::steady_clock::duration elapsed = std::chrono::steady_clock::now() - start;
+
+    // Counts cut short by a stop are no use for comparing
+    if ( !continueThinking )
+    {
+        return;
+    }
+
+    // Report in file order, whatever order the jobs finished in
+    unsigned long long totalNodes = 0;
+    size_t mismatches = 0;
+    for ( const PerftJob& job : jobs )
+    {
+        double seconds = std::chrono::duration<double>( job.elapsed ).count();
+        unsigned long longNPS = seconds == 0 ? 0 : std::lround( job.nodes / seconds );
+
+        if ( job.nodes == job.expected )
+        {
+            Log::Info << "Total node count at depth " << job.depth << " is " << job.nodes << ". Time " << seconds << "s (" << longNPS << " nps) for " << fenStrings[ job.position ] << std::endl;
+        }
+        else
+        {
+            Log::Error << "Total node count at depth " << job.depth << " is " << job.nodes << " but expected to be " << job.expected << ". Time " << seconds << "s (" << longNPS << " nps) for " << fenStrings[ job.position ] << std::endl;
+            mismatches++;
+        }
+
+        if ( report != nullptr )
+        {
+            report->add( fenStrings[ job.position ], job.depth, job.expected, job.nodes, job.elapsed );
+        }
+
+        totalNodes += job.nodes;
+    }
+
+    double seconds = std::chrono::duration<double>( elapsed ).count();
+
+    Log::Info << "Perft suite of " << jobs.size() << " counts finished with " << mismatches << " mismatch(es). " << totalNodes << " nodes in "
+              << seconds << "s (" << ( seconds == 0 ? 0 : std::lround( totalNodes / seconds ) ) << " nps)" << std::endl;
+
+    if ( mismatches > 0 )
+    {
+        perftFailed = true;
+    }
+}
+
+// Special bench command
+
+// A fixed set of positions for benchmarking - openings, middlegames and endgames, quiet and tactical - which
+// must not change, or the node counts of different builds can no longer be compared
+static const char* const benchPositions[] =
+{
+    "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+    "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 10",
+    "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 11",
+    "4rrk1/pp1n3p/3q2pQ/2p1pb2/2PP4/2P3N1/P2B2PP/4RRK1 b - - 7 19",
+    "rq3rk1/ppp2ppp/1bnpb3/3N2B1/3NP3/7P/PPPQ1PP1/2KR3R w - - 7 14",
+    "r1bq1r1k/1pp1n1pp/1p1p4/4p2Q/4Pp2/1BNP4/PPP2PPP/3R1RK1 w - - 2 14",
+    "r3r1k1/2p2ppp/p1p1bn2/8/1q2P3/2NPQN2/PPP3PP/R4RK1 b - - 2 15",
+    "r1bbk1nr/pp3p1p/2n5/1N4p1/2Np1B2/8/PPP2PPP/2KR1B1R w kq - 0 13",
+    "r1bq1rk1/ppp1nppp/4n3/3p3Q/3P4/1BP1B3/PP1N2PP/R4RK1 w - - 1 16",
+    "4r1k1/r1q2ppp/ppp2n2/4P3/5Rb1/1N1BQ3/PPP3PP/R5K1 w - - 1 17",
+    "2rqkb1r/ppp2p2/2npb1p1/1N1Nn2p/2P1PP2/8/PP2B1PP/R1BQK2R b KQ - 0 11",
+    "r1bq1r1k/b1p1npp1/p2p3p/1p6/3PP3/1B2NN2/PP3PPP/R2Q1RK1 w - - 1 16",
+    "3r1rk1/p5pp/bpp1pp2/8/q1PP1P2/b3P3/P2NQRPP/1R2B1K1 b - - 6 22",
+    "r1q2rk1/2p1bppp/2Pp4/p6b/Q1PNp3/4B3/PP1R1PPP/2K4R w - - 2 18",
+    "4k2r/1pb2ppp/1p2p3/1R1p4/3P4/2r1PN2/P4PPP/1R4K1 b - - 3 22",
+    "3q2k1/pb3p1p/4pbp1/2r5/PpN2N2/1P2P2P/5PP1/Q2R2K1 b - - 4 26",
+    "6k1/6p1/6Pp/ppp5/3pn2P/1P3K2/1PP2P2/8 b - - 3 54",
+    "3b4/5kp1/1p1p1p1p/pP1PpP1P/P1P1P3/3KN3/8/8 w - - 0 1",
+    "2K5/p7/7P/5pR1/8/5k2/r7/8 w - - 0 1",
+    "8/6pk/1p6/8/PP3p1p/5P2/4KP1q/3Q4 w - - 0 1",
+    "7k/3p2pp/4q3/8/4Q3/5Kp1/P6b/8 w - - 0 1",
+    "8/2p5/8/2kPKp1p/2p4P/2P5/3P4/8 w - - 0 1",
+    "8/1p3pp1/7p/5P1P/2k3P1/8/2K2P2/8 w - - 0 1",
+    "8/pp2r1k1/2p1p3/3pP2p/1P1P1P1P/P5KR/8/8 w - - 0 1",
+    "8/3p4/p1bk3p/Pp6/1Kp1PpPp/2P2P1P/2P5/5B2 b - - 0 1",
+    "5k2/7R/4P2p/5K2/p1r2P1p/8/8/8 b - - 0 1",
+    "6k1/6p1/P6p/r1N5/5p2/7P/1b3PP1/4R1K1 w - - 0 1",
+    "1r3k2/4q3/2Pp3b/3Bp3/2Q2p2/1p1P2P1/1P2KP2/3N4 w - - 0 1",
+    "6k1/4pp1p/3p2p1/P1pPb3/R7/1r2P1PP/3B1P2/6K1 w - - 0 1",
+    "8/3p3B/5p2/5P2/p7/PP5b/k7/6K1 w - - 0 1",
+    "5rk1/q6p/2p3bR/1pPp1rP1/1P1Pp3/P3B1Q1/1K3P2/R7 w - - 93 90",
+    "4rrk1/1p1nq3/p7/2p1P1pp/3P2bp/3Q1Bn1/PPPB4/1K2R1NR w - - 40 21",
+    "r3k2r/3nnpbp/q2pp1p1/p7/Pp1PPPP1/4BNN1/1P5P/R2Q1RK1 w kq - 0 16",
+    "3Qb1k1/1r2ppb1/pN1n2q1/Pp1Pp1Pr/4P2p/4BP2/4B1R1/1R5K b - - 11 40",
+    "4k3/3q1r2/1N2r1b1/3ppN2/2nPP3/1B1R2n1/2R1Q3/3K4 w - - 5 1",
+    "r1bqkb1r/pppp1ppp/2n2n2/4p2Q/2B1P3/8/PPPP1PPP/RNB1K1NR w KQkq - 4 4",
+    "rnbqkb1r/pp1ppppp/5n2/2p5/2P5/2N5/PP1PPPPP/R1BQKBNR w KQkq - 2 3",
+    "r1bqk2r/pppp1ppp/2n2n2/2b1p3/2B1P3/2N2N2/PPPP1PPP/R1BQK2R w KQkq - 6 5",
+    "rnbqk2r/ppp1bppp/4pn2/3p2B1/2PP4/2N5/PP2PPPP/R2QKBNR w KQkq - 4 5",
+    "r2qkbnr/ppp2ppp/2np4/4p3/2B1P1b1/5N2/PPPP1PPP/RNBQ1RK1 w kq - 2 5",
+    "6k1/5ppp/8/8/8/8/5PPP/3R2K1 w - - 0 1",
+    "k7/8/KQ6/8/8/8/8/8 w - - 0 1",
+    "8/8/8/8/5kp1/P7/8/1K1N4 w - - 0 1",
+    "8/8/8/5N2/8/p7/8/2NK3k w - - 0 1",
+    "8/3k4/8/8/8/4B3/4KB2/2B5 w - - 0 1",
+    "8/8/1P6/5pr1/8/4R3/7k/2K5 w - - 0 1",
+    "8/2p4P/8/kr6/6R1/8/8/1K6 w - - 0 1",
+    "8/8/3P3k/8/1p6/8/1P6/1K3n2 b - - 0 1",
+    "8/R7/2q5/8/6k1/8/1P5p/K6R w - - 0 124",
+    "6k1/3b3r/1p1p4/p1n2p2/1PPNpP1q/P3Q1p1/1R1RB1P1/5K2 b - - 0 1",
+    "r2r1n2/pp2bk2/2p1p2p/3q4/3PN1QP/2P3R1/P4PP1/5RK1 w - - 0 1"
+};
+
+void Engine::benchCommand( std::vector<std::string_view>& arguments )
+{
+    UCI_DEBUG << "Received bench";
+
+    // Command syntax:
+    //  bench [depth]
+    //      depth is the search depth for every position, defaulting to BENCH_DEPTH
+
+    int depth = arguments.empty() ? BENCH_DEPTH : Utilities::toInt( arguments[ 0 ] );
+    if ( depth < 1 )
+    {
+        UCI_ERROR << "Parsing issue with bench command";
+        return;
+    }
+
+    benchImpl( depth );
+}
+
+void Engine::benchImpl( int depth )
+{
+    stopImpl();
+
+    // Start from nothing learned, so that the node count depends only on the build
+    moveOrdering.clear();
+    Evaluation::clearEvaluationCache();
+    thinkingHistory.clear();
+
+    // Search on this thread, one position after another, keeping the moves to ourselves
+    broadcastThinkingOutcome = false;
+
+    const size_t positions = sizeof( benchPositions ) / sizeof( benchPositions[ 0 ] );
+    unsigned long long totalNodes = 0;
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+    for ( size_t index = 0; index < positions && !quitting; index++ )
+    {
+        Board board = Fen::fromPosition( benchPositions[ index ] );
+
+        thinking( this, &board, new GoContext( std::vector<Move>(), false, 0, 0, 0, 0, 0, depth, 0, 0, 0, false ) );
+
+        // The search ran on this thread, so its counts are this thread's
+        unsigned long long nodes = Evaluation::getStatistics().nodes;
+        totalNodes += nodes;
+
+        Log::Debug << "Bench position " << ( index + 1 ) << " of " << positions << ": " << nodes << " nodes" << std::endl;
+    }
+
+    std::chrono::steady_clock::duration elapsed = std::chrono::steady_clock::now() - start;
+    long long milliseconds = std::chrono::duration_cast<std::chrono::milliseconds>( elapsed ).count();
+
+    UCI_INFO << "Bench: " << positions << " positions to depth " << depth << ", " << totalNodes << " nodes, " << milliseconds << " ms, "
+             << ( milliseconds == 0 ? 0 : totalNodes * 1000 / milliseconds ) << " nps";
 }
 
 void Engine::listVisibleOptions()
 {
     broadcaster.option( OPTION_BENCH, benchmarking );
+    broadcaster.option( OPTION_EVALUATOR, EVALUATOR_CLASSIC, { EVALUATOR_CLASSIC, EVALUATOR_NETWORK } );
+    broadcaster.option( OPTION_EVAL_CACHE, EvaluationCache::DEFAULT_SIZE_MB, 0, EvaluationCache::MAXIMUM_SIZE_MB );
 }
  
 // Silent implementations - do the work, but do not directly communicate over uci, allowing the 
@@ -827,7 +1265,9 @@ void Engine::listVisibleOptions()
 
 void Engine::initializeImpl()
 {
-    Bitboard::initialize();
+    // The network is optional - without it, the classic evaluator is the only choice
+    Network::load( NETWORK_FILENAME );
+
     initialized = true;
 }
 
@@ -845,8 +1285,17 @@ void Engine::stopImpl( ThinkingOutcome thinkingOutcome )
     // Set this volatile switch and it will be detected by a thinking thread if one is active
     continueThinking = false;
 
+    joinImpl();
+}
+
+void Engine::joinImpl()
+{
     // Wait for the thread to stop
-    thinkingThread->join();
+    {
+        SearchTrace::Scope scope( "wait for search to stop" );
+
+        thinkingThread->join();
+    }
 
     Log::Trace << "Thread stopped" << std::endl;
 
@@ -856,6 +1305,8 @@ void Engine::stopImpl( ThinkingOutcome thinkingOutcome )
 
     delete thinkingBoard;
     thinkingBoard = nullptr;
+
+    perftRunning = false;
 }
 
 void Engine::isreadyImpl()
@@ -901,32 +1352,75 @@ void Engine::setoptionImpl( std::string& name, std::string& value )
     {
         setBenchmarking( value == "true" );
     }
+    else if ( name == OPTION_EVALUATOR )
+    {
+        if ( value == EVALUATOR_NETWORK )
+        {
+            if ( !Evaluation::setEvaluator( Evaluation::Evaluator::NETWORK ) )
+            {
+                UCI_WARN << "Network evaluator unavailable without " << NETWORK_FILENAME << ". Using classic evaluator";
+            }
+        }
+        else if ( value == EVALUATOR_CLASSIC )
+        {
+            Evaluation::setEvaluator( Evaluation::Evaluator::CLASSIC );
+        }
+        else
+        {
+            UCI_ERROR << "Unknown evaluator: " << value;
+        }
+    }
+    else if ( name == OPTION_EVAL_CACHE )
+    {
+        try
+        {
+            Evaluation::setEvaluationCacheSize( std::stoull( value ) );
+        }
+        catch ( const std::exception& )
+        {
+            UCI_ERROR << "Invalid evaluation cache size: " << value;
+        }
+    }
 }
 
-void Engine::positionImpl( const std::string& fenString, std::vector<std::string> moves )
+void Engine::positionImpl( std::string_view fenString, const std::vector<Move>& moves )
 {
     Log::Info << "Processing FEN string " << fenString << " and " << moves.size() << " moves" << std::endl;
-    Fen fen = Fen::fromPosition( fenString );
-    
-    Log::Debug << "Position:" << std::endl;
-    fen.dumpBoard();
 
-    std::vector< Move > moveList;
-    if ( moves.size() > 0 )
+    Log::Trace( [&] ( const Log::Logger& logger )
     {
-        Log::Debug << "Initial moves:" << std::endl;
-
-        for ( std::string move : moves )
+        logger << "Moves:";
+        for ( const Move& move : moves )
         {
-            Move m = Move::fromString( move );
+            char text[ Move::UCI_BUFFER_SIZE ];
+            move.toUci( text );
 
-            moveList.push_back( m );
-            Log::Debug << "  " << m.toString() << std::endl;
+            logger << " " << text;
+        }
+        logger << std::endl;
+    } );
+
+    if ( gameContext != nullptr && gameContext->isContinuedBy( fenString, moves ) )
+    {
+        // Same game, moved on - just play the new moves, keeping what searches so far have learned
+        Log::Debug << "Continuing game with " << ( moves.size() - gameContext->getMoves().size() ) << " new moves" << std::endl;
+
+        for ( size_t index = gameContext->getMoves().size(); index < moves.size(); index++ )
+        {
+            gameContext->addMove( moves[ index ] );
         }
     }
+    else
+    {
+        Log::Debug << "Position:" << std::endl;
+        Fen::fromPosition( std::string( fenString ) ).dumpBoard();
 
-    // Set the new game context
-    gameContext = new GameContext( fen, moveList );
+        // Set the new game context
+        releaseGameContext();
+        gameContext = new GameContext( fenString, moves );
+
+        moveOrdering.clear();
+    }
 
     // Reset for next game
     ucinewgameReceived = false;
@@ -936,26 +1430,22 @@ void Engine::goImpl( GoContext* goContext )
 {
     Log::Info << "Go: depth=" << goContext->getDepth() << std::endl;
 
+    SearchTrace::instant( "go", "depth", goContext->getDepth() );
+
     stopImpl();
 
     // If we get a go without a prior position, go with a default setup
     if ( gameContext == nullptr )
     {
-        positionImpl( Fen::startingPosition, std::vector<std::string>() );
+        positionImpl( Fen::startingPosition, std::vector<Move>() );
     }
 
     // Report bestmove when thinking is done
     broadcastThinkingOutcome = true;
 
-    // Construct the position to think from
-    Board initialBoard( gameContext->getFEN() );
-    for ( std::vector<Move>::const_iterator it = gameContext->getMoves().begin(); it != gameContext->getMoves().end(); it++ )
-    {
-        initialBoard = initialBoard.makeMove( *it );
-    }
-
-    // Use this as the board to work from
-    thinkingBoard = new Board( initialBoard );
+    // Think from the game's current position, which is kept up to date as position commands arrive
+    thinkingHistory = gameContext->getHistory();
+    thinkingBoard = new Board( gameContext->getBoard() );
     thinkingThread = new std::thread( &Engine::thinking, this, thinkingBoard, goContext );
 
     Log::Trace << "Thread " << thinkingThread->get_id() << " running" << std::endl;
@@ -963,7 +1453,8 @@ void Engine::goImpl( GoContext* goContext )
 
 // Special perft command
 
-unsigned long Engine::perftImpl( int depth, Board board, bool divide )
+template<bool collectStatistics>
+unsigned long Engine::perftImpl( int depth, Board board, bool divide, PerftStatistics* statistics )
 {
     unsigned long nodes = 0;
 
@@ -972,6 +1463,12 @@ unsigned long Engine::perftImpl( int depth, Board board, bool divide )
         return 1;
     }
 
+    // Checked above the leaves only, where it costs next to nothing
+    if ( depth > 1 && !continueThinking )
+    {
+        return 0;
+    }
+
     std::vector<Move> moves = board.getMoves();
 
     for ( std::vector<Move>::iterator it = moves.begin(); it != moves.end(); it++ )
@@ -979,22 +1476,120 @@ unsigned long Engine::perftImpl( int depth, Board board, bool divide )
         Move& move = *it;
         Board tBoard = board.makeMove( move );
 
+        if constexpr ( collectStatistics )
+        {
+            if ( depth == 1 )
+            {
+                tallyLeaf( move, tBoard, *statistics );
+            }
+        }
+
         if ( divide )
         {
-            unsigned long moveNodes = perftImpl( depth - 1, tBoard );
+            unsigned long moveNodes = perftImpl<collectStatistics>( depth - 1, tBoard, false, statistics );
             nodes += moveNodes;
 
             Log::Debug << move.toString() << " : " << moveNodes << " " << tBoard.toFENString() << std::endl;
         }
         else
         {
-            nodes += perftImpl( depth - 1, tBoard );
+            nodes += perftImpl<collectStatistics>( depth - 1, tBoard, false, statistics );
         }
     }
 
+    if ( depth == 2 )
+    {
+        perftProgress( nodes );
+    }
+
     return nodes;
 }
 
+void Engine::perftProgress( unsigned long long nodes )
+{
+    unsigned long long total = perftNodes.fetch_add( nodes, std::memory_order_relaxed ) + nodes;
+
+    std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+    std::chrono::steady_clock::rep due = perftNextProgress.load( std::memory_order_relaxed );
+
+    if ( now.time_since_epoch().count() < due )
+    {
+        return;
+    }
+
+    // Only one thread of a suite reports, the others carry on counting
+    if ( !perftNextProgress.compare_exchange_strong( due, ( now + PERFT_PROGRESS_INTERVAL ).time_since_epoch().count(), std::memory_order_relaxed ) )
+    {
+        return;
+    }
+
+    long long milliseconds = std::chrono::duration_cast<std::chrono::milliseconds>( now - perftStart ).count();
+    unsigned long long nps = milliseconds == 0 ? 0 : total * 1000 / milliseconds;
+
+    Log::Debug << "Perft progress: " << total << " nodes, " << milliseconds << " ms, " << nps << " nps" << std::endl;
+
+    std::vector<std::pair<std::string, std::string>> values;
+    values.push_back( std::pair<std::string, std::string>( "time", std::to_string( milliseconds ) ) );
+    values.push_back( std::pair<std::string, std::string>( "nodes", std::to_string( total ) ) );
+    values.push_back( std::pair<std::string, std::string>( "nps", std::to_string( nps ) ) );
+
+    broadcaster.info( values );
+}
+
+void Engine::tallyLeaf( const Move& move, Board& leaf, PerftStatistics& statistics )
+{
+    if ( move.isCapture() )
+    {
+        statistics.captures++;
+    }
+
+    if ( move.isEnPassantCapture() && !move.isPromotion() )
+    {
+        statistics.enPassantCaptures++;
+    }
+
+    if ( move.isCastling() )
+    {
+        statistics.castles++;
+    }
+
+    if ( move.isPromotion() )
+    {
+        statistics.promotions++;
+    }
+
+    unsigned long long checkers = leaf.getCheckers();
+    if ( checkers )
+    {
+        statistics.checks++;
+
+        // Double checks are counted as such, rather than as discovered checks too, as in the published tables
+        if ( std::popcount( checkers ) > 1 )
+        {
+            statistics.doubleChecks++;
+        }
+        else
+        {
+            // Checks from anything other than the piece moved - or the rook, when castling, which lands between the king's squares
+            unsigned long long moved = Bitboard::indexToBit( move.getTo() );
+            if ( move.isCastling() )
+            {
+                moved |= Bitboard::indexToBit( ( move.getFrom() + move.getTo() ) / 2 );
+            }
+
+            if ( checkers & ~moved )
+            {
+                statistics.discoveredChecks++;
+            }
+        }
+
+        if ( leaf.getMoves().empty() )
+        {
+            statistics.checkmates++;
+        }
+    }
+}
+
 // Internal methods
 
 class Thoughts
@@ -1021,8 +1616,41 @@ public:
     }
 };
 
+void Engine::reportStatistics( Engine& engine, const Evaluation::Statistics& statistics, unsigned long long lastIterationNodes, unsigned long long previousIterationNodes )
+{
+    // As a percentage, guarding against nothing to divide by
+    auto percentage = [] ( unsigned long long part, unsigned long long whole )
+    {
+        return whole == 0 ? 0 : part * 100 / whole;
+    };
+
+    Engine::UciLogger( engine, Log::Level::INFO ).log( "" ) << "Nodes " << statistics.nodes << " (" << statistics.leafNodes << " at the horizon)";
+
+    Engine::UciLogger( engine, Log::Level::INFO ).log( "" ) << "Beta cutoffs " << statistics.betaCutoffs << ", "
+                                                            << percentage( statistics.firstMoveCutoffs, statistics.betaCutoffs ) << "% by the first move";
+
+    Engine::UciLogger( engine, Log::Level::INFO ).log( "" ) << "Hash moves found " << statistics.hashMoveHits << " of " << statistics.hashMoveProbes << " probes ("
+                                                            << percentage( statistics.hashMoveHits, statistics.hashMoveProbes ) << "%), "
+                                                            << statistics.hashMoveCutoffs << " cutoffs";
+
+    Engine::UciLogger( engine, Log::Level::INFO ).log( "" ) << "Evaluation cache hits " << statistics.cacheHits << " of " << statistics.cacheProbes << " probes ("
+                                                            << percentage( statistics.cacheHits, statistics.cacheProbes ) << "%)";
+
+    Engine::UciLogger( engine, Log::Level::INFO ).log( "" ) << "Lazy evaluation exits " << statistics.lazyExits;
+
+    // How many times more nodes the last iteration took than the one before
+    if ( previousIterationNodes > 0 )
+    {
+        Engine::UciLogger( engine, Log::Level::INFO ).log( "" ) << "Effective branching factor " << std::fixed << std::setprecision( 2 )
+                                                                << static_cast<double>( lastIterationNodes ) / previousIterationNodes;
+    }
+}
+
 void Engine::thinking( Engine* engine, Board* board, GoContext* context )
 {
+    SearchTrace::nameThread( "search" );
+    SearchTrace::begin( "search" );
+
     // TODO remove this when no longer required
     std::srand( static_cast<unsigned int>( std::time( nullptr ) ) );
 
@@ -1036,29 +1664,57 @@ void Engine::thinking( Engine* engine, Board* board, GoContext* context )
 
     Thoughts thoughts;
 
+    // Carry move ordering knowledge over from earlier searches in this game, apart from killers, which are
+    // relative to the root
+    engine->moveOrdering.clearKillers();
+    Evaluation::setMoveOrdering( &engine->moveOrdering );
+
+    // Repetitions are found from the game's positions, then the search path from this one
+    PositionHistory& positionHistory = Evaluation::getPositionHistory();
+    positionHistory = engine->thinkingHistory;
+    positionHistory.push( board->getHashKey() );
+
+    // The network evaluator's first layer is built for the root, then updated move by move down the search path
+    AccumulatorStack& accumulators = Evaluation::getAccumulators();
+    if ( Network::isActive() )
+    {
+        accumulators.refresh( 0, *board );
+    }
+
+    // Count evaluation work for this search only
+    Evaluation::Statistics& evaluationStatistics = Evaluation::getStatistics();
+    evaluationStatistics = Evaluation::Statistics();
+
     // TODO This is debug code. Remove when we're happy to lose it
     Log::Debug << "Current position scoring: " << Evaluation::scorePosition( *board, board->getActiveColor() ) << std::endl;
 
+    // Nodes searched by the last two completed iterations, for the effective branching factor
+    unsigned long long lastIterationNodes = 0;
+    unsigned long long previousIterationNodes = 0;
+
     unsigned int loop = 0;
     //while ( engine->continueThinking && !engine->quitting )
     while ( !engine->quitting && (engine->continueThinking || thoughts.getBestMove().isNullMove() ))
     {
         do
         {
-            std::vector<Move> candidateMoves = board->getMoves();
+            std::vector<Move> candidateMoves;
 
-            // Filter the moves down to the requested 'searchmoves' subset, if there is one
-            if ( !context->getSearchMoves().empty() )
+            if ( context->getSearchMoves().empty() )
+            {
+                candidateMoves = board->getMoves();
+            }
+            else
             {
-                for ( std::vector<Move>::iterator it = candidateMoves.begin(); it != candidateMoves.end(); )
+                // Check the requested 'searchmoves' one at a time rather than generating every move to find them.
+                // They come from UCI without flags, so take the flags from the position
+                for ( const Move& searchMove : context->getSearchMoves() )
                 {
-                    if( std::find( context->getSearchMoves().begin(), context->getSearchMoves().end(), *it ) == context->getSearchMoves().end() )
-                    {
-                        it = candidateMoves.erase( it );
-                    }
-                    else
+                    Move move = board->completeMove( searchMove );
+
+                    if ( !move.isNullMove() && board->isLegal( move ) && std::find( candidateMoves.begin(), candidateMoves.end(), move ) == candidateMoves.end() )
                     {
-                        it++;
+                        candidateMoves.push_back( move );
                     }
                 }
             }
@@ -1101,68 +1757,114 @@ void Engine::thinking( Engine* engine, Board* board, GoContext* context )
             } );
 
             // Start of minmax/alphabeta/negamax/whatever
-            // For each move at this level, use the recursive algorithm to arrive at a score and then go with the best
+            // For each move at this level, use the recursive algorithm to arrive at a score and then go with the best.
+            // Deepen one iteration at a time: each iteration leaves hash moves, killers and counter-moves that order
+            // the next one, and an interruption still leaves the best move from the last completed iteration
 
-            Move bestMove = Move::nullMove;
-            short bestScore = std::numeric_limits<short>::lowest();
-            for ( std::vector<Move>::const_iterator it = candidateMoves.cbegin(); it != candidateMoves.cend(); it++ )
+            Move previousBestMove = Move::nullMove;
+            for ( unsigned short iteration = 1; iteration <= depth; iteration++ )
             {
-                Log::Debug( [&] ( const Log::Logger& logger) 
-                {
-                    logger << "Considering " << ( *it ).toString() << std::endl;
-                } ); 
+                SearchTrace::Scope scope( "iteration", "depth", iteration );
 
-                short score = Evaluation::minimax( board->makeMove( *it ),
-                                                   depth,
-                                                   std::numeric_limits<short>::lowest(),
-                                                   std::numeric_limits<short>::max(),
-                                                   false, 
-                                                   board->getActiveColor() );
+                unsigned long long iterationStartNodes = evaluationStatistics.nodes;
 
-                if ( score > bestScore )
+                // Try the last iteration's best move first, keeping the order of the rest
+                std::vector<Move>::iterator previousBest = std::find( candidateMoves.begin(), candidateMoves.end(), previousBestMove );
+                if ( previousBest != candidateMoves.end() )
                 {
-                    bestScore = score;
-                    bestMove = *it;
+                    std::rotate( candidateMoves.begin(), previousBest, previousBest + 1 );
                 }
 
-                Log::Debug( [&] ( const Log::Logger& logger )
+                Move bestMove = Move::nullMove;
+                short bestScore = std::numeric_limits<short>::lowest();
+                bool interrupted = false;
+                for ( std::vector<Move>::const_iterator it = candidateMoves.cbegin(); it != candidateMoves.cend(); it++ )
                 {
-                    logger << "--Score for " << ( *it ).toString() << " is " << score << std::endl;
-                } ); 
-            }
+                    // Only give up on an iteration if an earlier one has established a move
+                    if ( engine->quitting || ( !engine->continueThinking && !thoughts.getBestMove().isNullMove() ) )
+                    {
+                        interrupted = true;
+                        break;
+                    }
+
+                    Log::Debug( [&] ( const Log::Logger& logger) 
+                    {
+                        logger << "Considering " << ( *it ).toString() << std::endl;
+                    } ); 
+
+                    // Moves that can't beat the best so far needn't be scored exactly
+                    Board child = board->makeMove( *it );
+                    if ( Network::isActive() )
+                    {
+                        accumulators.update( 0, *board, child, *it );
+                    }
+
+                    short score = Evaluation::minimax( child,
+                                                       iteration,
+                                                       1,
+                                                       bestScore,
+                                                       std::numeric_limits<short>::max(),
+                                                       false, 
+                                                       board->getActiveColor(),
+                                                       *it );
+
+                    if ( score > bestScore || bestMove.isNullMove() )
+                    {
+                        bestScore = score;
+                        bestMove = *it;
+                    }
+
+                    Log::Debug( [&] ( const Log::Logger& logger )
+                    {
+                        logger << "--Score for " << ( *it ).toString() << " is " << score << std::endl;
+                    } ); 
+                }
+
+                if ( interrupted )
+                {
+                    SearchTrace::instant( "interrupted" );
+                    Log::Debug << "Interrupted during iteration " << iteration << std::endl;
+                    break;
+                }
 
-            // If we haven't got a move in mind, establish one
-            if ( thoughts.getBestMove().isNullMove() )
-            {
                 thoughts = Thoughts( bestMove );
+                previousBestMove = bestMove;
 
-                engine->continueThinking = false;
-            }
+                previousIterationNodes = lastIterationNodes;
+                lastIterationNodes = evaluationStatistics.nodes - iterationStartNodes;
 
-            // TODO this probably wants to be a better check
-            if ( --depth == 0 )
-            {
-                Log::Debug << "Reached search depth" << std::endl;
-                engine->continueThinking = false;
-                break;
+                Log::Debug << "Completed iteration " << iteration << " with " << bestMove.toString() << " scoring " << bestScore << std::endl;
             }
+
+            Log::Debug << "Reached search depth" << std::endl;
+            engine->continueThinking = false;
+            break;
         }
         while ( engine->continueThinking && !engine->quitting );
     }
 
+    if ( engine->benchmarking )
+    {
+        reportStatistics( *engine, evaluationStatistics, lastIterationNodes, previousIterationNodes );
+    }
+
+    SearchTrace::end( "search" );
+
     if ( engine->broadcastThinkingOutcome )
     {
+        SearchTrace::Scope scope( "bestmove" );
+
         if ( thoughts.getPonderMove().isNullMove() )
         {
             Log::Info << "Broadcasting best move: " << thoughts.getBestMove().toString() << std::endl;
 
-            engine->broadcaster.bestmove( thoughts.getBestMove().toString() );
+            engine->broadcaster.bestmove( thoughts.getBestMove() );
         }
         else
         {
             Log::Info << "Broadcasting best move: " << thoughts.getBestMove().toString() << " with ponder: " << thoughts.getPonderMove().toString() << std::endl;
 
-            engine->broadcaster.bestmove( thoughts.getBestMove().toString(), thoughts.getPonderMove().toString() );
+            engine->broadcaster.bestmove( thoughts.getBestMove(), thoughts.getPonderMove() );
         }
     }
 
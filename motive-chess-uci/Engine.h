@@ -1,16 +1,26 @@
 #pragma once
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <iostream>
 #include <string>
+#include <string_view>
 #include <thread>
 #include <vector>
 
+#include "Board.h"
 #include "Broadcaster.h"
 #include "CopyProtection.h"
+#include "Evaluation.h"
 #include "Fen.h"
 #include "GameContext.h"
 #include "GoContext.h"
 #include "Log.h"
+#include "MoveOrdering.h"
+#include "Network.h"
+#include "PerftReport.h"
+#include "PositionHistory.h"
 #include "Registration.h"
 #include "VersionInfo.h"
 #include "Utilities.h"
@@ -26,6 +36,20 @@ public:
 
 private:
     inline static const std::string OPTION_BENCH = "Benchmark";
+    inline static const std::string OPTION_EVALUATOR = "Evaluator";
+    inline static const std::string OPTION_EVAL_CACHE = "EvalCache";
+
+    // Deep enough to exercise the search, shallow enough to finish in seconds
+    inline static const int BENCH_DEPTH = 4;
+
+    // How often a perft on the worker thread reports its progress
+    inline static const std::chrono::seconds PERFT_PROGRESS_INTERVAL = std::chrono::seconds( 1 );
+
+    inline static const std::string EVALUATOR_CLASSIC = "classic";
+    inline static const std::string EVALUATOR_NETWORK = "network";
+
+    // Network evaluator weights, looked for in the working directory at startup
+    inline static const std::string NETWORK_FILENAME = "motive-chess.nnue";
 
     // What to do with findings when thinking concludes
     enum class ThinkingOutcome
@@ -54,8 +78,31 @@ private:
     std::thread* thinkingThread;
     Board* thinkingBoard;
 
+    // Positions of the game before the thinking board
+    PositionHistory thinkingHistory;
+
+    // What searches have learned about move ordering, kept for the rest of the game
+    MoveOrdering moveOrdering;
+
+    // Reused by each position command, so that parsing the growing move list of a game doesn't allocate
+    std::vector<Move> positionMoves;
+
     GameContext* gameContext;
 
+    // Where perft counts are recorded, if anywhere, for the duration of a perft file run
+    PerftReport* perftReport;
+
+    // Whether any perft count has failed to match its expected count, for the exit status
+    bool perftFailed;
+
+    // Whether the worker thread is counting perft rather than thinking. Either way, continueThinking stops it
+    bool perftRunning;
+
+    // Leaves counted so far by the perft on the worker thread, shared by the threads of a suite, and when next to report them
+    std::atomic<unsigned long long> perftNodes;
+    std::atomic<std::chrono::steady_clock::rep> perftNextProgress;
+    std::chrono::steady_clock::time_point perftStart;
+
     class UciLogger
     {
     public:
@@ -92,6 +139,14 @@ private:
     };
 
     static void thinking( Engine* engine, Board* board, GoContext* context );
+    static void perfting( Engine* engine, std::vector<std::string> arguments );
+
+    /// <summary>
+    /// Report how a search went, as info strings
+    /// </summary>
+    /// <param name="lastIterationNodes">nodes searched by the last completed iteration</param>
+    /// <param name="previousIterationNodes">nodes searched by the iteration before that, or zero if there wasn't one</param>
+    static void reportStatistics( Engine& engine, const Evaluation::Statistics& statistics, unsigned long long lastIterationNodes, unsigned long long previousIterationNodes );
 
     // Helper methods
     void listVisibleOptions();
@@ -106,56 +161,102 @@ private:
 
     // Implementation methods that do not broadcast notifications 
     void stopImpl( ThinkingOutcome thinkingOutcome = ThinkingOutcome::DISCARD );
+    void joinImpl();
     void isreadyImpl();
     void debugImpl( DebugSwitch flag );
     void registerImpl();
     void registerImpl( std::string& name, std::string& code );
     void setoptionImpl( std::string& name, std::string& value );
-    void positionImpl( const std::string& fen, std::vector<std::string> moves );
+    void positionImpl( std::string_view fenString, const std::vector<Move>& moves );
     void goImpl( GoContext* goContext );
 
-    unsigned long perftImpl( int depth, Board board, bool divide = false );
+    /// <summary>
+    /// What the moves to the leaves of a perft count were, for narrowing down where move generation goes wrong
+    /// </summary>
+    class PerftStatistics
+    {
+    public:
+        unsigned long long captures;
+        unsigned long long enPassantCaptures;
+        unsigned long long castles;
+        unsigned long long promotions;
+        unsigned long long checks;
+        unsigned long long discoveredChecks;
+        unsigned long long doubleChecks;
+        unsigned long long checkmates;
+
+        PerftStatistics() :
+            captures( 0 ),
+            enPassantCaptures( 0 ),
+            castles( 0 ),
+            promotions( 0 ),
+            checks( 0 ),
+            discoveredChecks( 0 ),
+            doubleChecks( 0 ),
+            checkmates( 0 )
+        {
+            // Nothing to do
+        }
+    };
+
+    /// <summary>
+    /// Count the leaves of the move tree. Collecting statistics is a separate instantiation, so that plain
+    /// counting pays nothing for it
+    /// </summary>
+    template<bool collectStatistics = false>
+    unsigned long perftImpl( int depth, Board board, bool divide = false, PerftStatistics* statistics = nullptr );
+
+    static void tallyLeaf( const Move& move, Board& leaf, PerftStatistics& statistics );
 
-    void perftDepth( Board& board, int depth );
-    void perftRange( Board& board, std::vector<std::pair<unsigned int, unsigned int>> expectedResults );
-    void perftFile( std::string& filename );
+    /// <summary>
+    /// Add to the leaves counted so far, and report them as info if it is time to
+    /// </summary>
+    void perftProgress( unsigned long long nodes );
+
+    void perftRun( std::vector<std::string>& arguments, bool expectsDepth );
+
+    void perftDepth( Board& board, const std::string& fenString, int depth );
+    void perftRange( Board& board, const std::string& fenString, std::vector<std::pair<unsigned int, unsigned int>> expectedResults );
+    void perftFile( std::string& filename, PerftReport* report );
+    void perftSuite( std::string& filename, unsigned int threads, PerftReport* report );
+    void perftStats( Board& board, const std::string& fenString, int depth );
+
+    static bool parsePerft( std::vector<std::string>& arguments, bool expectsDepth, int& depth, std::string& fenString, std::vector<std::pair<unsigned int, unsigned int>>& expectedResults );
+    static void splitPerftLine( const std::string& line, std::vector<std::string>& arguments );
+
+    void benchImpl( int depth );
+
+    static std::string stripQuotes( const std::string& text );
 
     void initializeImpl();
 
-    std::vector<std::string> getGoDirectives()
+    static bool isGoDirective( std::string_view word )
     {
-        std::vector<std::string> directives;
-        
-        directives.push_back( "searchmoves" );
-        directives.push_back( "ponder" );
-        directives.push_back( "wtime" );
-        directives.push_back( "btime" );
-        directives.push_back( "winc" );
-        directives.push_back( "binc" );
-        directives.push_back( "movestogo" );
-        directives.push_back( "depth" );
-        directives.push_back( "nodes" );
-        directives.push_back( "mate" );
-        directives.push_back( "movetime" );
-        directives.push_back( "infinite" );
-
-        return directives;
+        static const std::string_view directives[] = { "searchmoves", "ponder", "wtime", "btime", "winc", "binc",
+                                                       "movestogo", "depth", "nodes", "mate", "movetime", "infinite" };
+
+        return std::find( std::begin( directives ), std::end( directives ), word ) != std::end( directives );
     }
 
 public:
     Engine( Broadcaster& broadcaster ) : 
         broadcaster( broadcaster ), 
         initialized( false ),
+        ucinewgameExpected( true ),
+        ucinewgameReceived( false ),
         benchmarking( false ),
+        debugging( DebugSwitch::OFF ),
         quitting( false ),
         continueThinking( false ),
         broadcastThinkingOutcome( false ),
-        debugging( DebugSwitch::OFF ),
-        ucinewgameExpected( true ),
-        ucinewgameReceived( false ),
-        gameContext( nullptr ),
         thinkingThread( nullptr ),
-        thinkingBoard( nullptr )
+        thinkingBoard( nullptr ),
+        gameContext( nullptr ),
+        perftReport( nullptr ),
+        perftFailed( false ),
+        perftRunning( false ),
+        perftNodes( 0 ),
+        perftNextProgress( 0 )
     {
         VersionInfo* versionInfo = VersionInfo::getVersionInfo();
 
@@ -176,23 +277,39 @@ public:
         stopImpl();
         releaseGameContext();
 
+        Network::shutdown();
+
         initialized = false;
     }
 
     void uciCommand();
-    void debugCommand( std::vector<std::string>& arguments );
+    void debugCommand( std::vector<std::string_view>& arguments );
     void isreadyCommand();
-    void setoptionCommand( std::vector<std::string>& arguments );
-    void registerCommand( std::vector<std::string>& arguments );
+    void setoptionCommand( std::vector<std::string_view>& arguments );
+    void registerCommand( std::vector<std::string_view>& arguments );
     void ucinewgameCommand();
-    void positionCommand( std::vector<std::string>& arguments );
-    void goCommand( std::vector<std::string>& arguments );
+    void positionCommand( std::vector<std::string_view>& arguments );
+    void goCommand( std::vector<std::string_view>& arguments );
     void stopCommand();
     void ponderhitCommand();
     bool quitCommand();
 
-    // Special perft command
-    void perftCommand( std::vector<std::string>& arguments, bool expectsDepth = true );
+    // Special perft command, counting on the worker thread
+    void perftCommand( std::vector<std::string>& arguments );
+
+    /// <summary>
+    /// Wait for a perft on the worker thread to finish, if there is one, for input that expects each command
+    /// to complete before the next
+    /// </summary>
+    void waitForPerft();
+
+    bool hasPerftFailed() const
+    {
+        return perftFailed;
+    }
+
+    // Special bench command
+    void benchCommand( std::vector<std::string_view>& arguments );
 
     // Option methods
 
@@ -1,18 +1,41 @@
 #include "Evaluation.h"
 
+#include <bit>
 #include <vector>
 
+#include "Bitboard.h"
 #include "Board.h"
 #include "Move.h"
+#include "MovePicker.h"
 #include "Log.h"
 #include "Utilities.h"
 
+// Pawn structure is cached per thread, so search threads never contend for it
+thread_local PawnHashTable pawnHashTable;
+
+// Static evaluations are shared between threads, with usage counted per thread
+EvaluationCache evaluationCache;
+thread_local Evaluation::Statistics statistics;
+
+// Killers, counter-moves and hash moves belong to the search thread that found them, unless the
+// thread is given longer lived ones to use
+thread_local MoveOrdering threadMoveOrdering;
+thread_local MoveOrdering* moveOrdering = &threadMoveOrdering;
+thread_local PositionHistory positionHistory;
+thread_local AccumulatorStack accumulators;
+
 // Array of 8 where we will ignore 0 and 7 (empty and unused, respecitively, from Piece definitions)
 short Evaluation::pieceWeights[] =
 {
     0, 100, 300, 300, 500, 900, 0, 0
 };
 
+// Penalty for each king zone square attacked, by type of attacker, indexed as pieceWeights
+short Evaluation::kingZoneAttackWeights[] =
+{
+    0, 4, 8, 8, 10, 15, 0, 0
+};
+
 short Evaluation::pawnAdvancementWhite[] =
 {
     0, 0, 10, 15, 20, 25, 30, 40
@@ -28,163 +51,511 @@ short Evaluation::pawnAdvancementFile[] =
     1, 1, 2, 3, 3, 2, 1, 1
 };
 
+bool Evaluation::setEvaluator( Evaluator evaluator )
+{
+    bool changed = Network::setActive( evaluator == Evaluator::NETWORK ) == ( evaluator == Evaluator::NETWORK );
+
+    // Cached scores came from whichever evaluator was in use before
+    clearEvaluationCache();
+
+    return changed;
+}
+
+void Evaluation::setEvaluationCacheSize( size_t megabytes )
+{
+    evaluationCache.resize( megabytes );
+}
+
+void Evaluation::clearEvaluationCache()
+{
+    evaluationCache.clear();
+}
+
+Evaluation::Statistics& Evaluation::getStatistics()
+{
+    return statistics;
+}
+
 /// <summary>
-/// Score the position from the perspective of NOT the activeColor player
+/// Score the position from the perspective of a given player. If the score is clearly going to fall
+/// outside the alpha/beta window, it may be returned before all terms are considered
 /// </summary>
 /// <param name="board">the board</param>
+/// <param name="accumulator">the network's first layer for the board, or nullptr to build it from the board</param>
+/// <param name="color">the player to score for</param>
+/// <param name="alpha">the lower bound of interest, from color's perspective</param>
+/// <param name="beta">the upper bound of interest, from color's perspective</param>
 /// <returns>a centipawn score</returns>
-short Evaluation::scorePosition( Board board, unsigned char color )
+short Evaluation::scorePosition( const Board& board, const Network::Accumulator* accumulator, unsigned char color, short alpha, short beta )
+{
+    bool isWhite = Piece::isWhite( color );
+    short score;
+
+    // Scores are cached from white's perspective, so they serve either player
+    if ( evaluationCache.isEnabled() )
+    {
+        statistics.cacheProbes++;
+
+        if ( evaluationCache.probe( board.getHashKey(), &score ) )
+        {
+            statistics.cacheHits++;
+
+            return isWhite ? score : -score;
+        }
+    }
+
+    if ( Network::isActive() )
+    {
+        // Outside the search, there's no accumulator kept up to date for the board
+        Network::Accumulator built;
+        if ( accumulator == nullptr )
+        {
+            AccumulatorStack::build( board, built );
+            accumulator = &built;
+        }
+
+        // The network scores from the perspective of the side to move
+        bool whiteToMove = Piece::isWhite( board.activeColor );
+
+        score = Network::evaluate( *accumulator, whiteToMove );
+        score = whiteToMove ? score : -score;
+    }
+    else
+    {
+        Board::PieceBitboards white;
+        Board::PieceBitboards black;
+        board.makePieceBitboards( true, white, black );
+
+        score = scoreMaterial( board, white, black );
+
+        // Skip the expensive terms if they can't bring the score back into the window. The partial score
+        // is only a bound, so it is not cached
+        short lazyScore = isWhite ? score : -score;
+        if ( lazyScore + LAZY_EVALUATION_MARGIN <= alpha || lazyScore - LAZY_EVALUATION_MARGIN >= beta )
+        {
+            statistics.lazyExits++;
+
+            return lazyScore;
+        }
+
+        score += scoreActivity( board, white, black );
+    }
+
+    if ( evaluationCache.isEnabled() )
+    {
+        evaluationCache.store( board.getHashKey(), score );
+    }
+
+    return isWhite ? score : -score;
+}
+
+short Evaluation::scoreMaterial( const Board& board, const Board::PieceBitboards& white, const Board::PieceBitboards& black )
 {
     short score = 0;
 
     // Piece differential
-    for ( int index = 0; index < 64; index++ )
+    for ( unsigned short piece = 1; piece <= 5; piece++ )
+    {
+        score += pieceWeights[ piece ] * ( std::popcount( white.pieceMask[ piece ] ) - std::popcount( black.pieceMask[ piece ] ) );
+    }
+
+    // Pawn structure
+    score += probePawnStructure( board, white, black ).score;
+
+    return score;
+}
+
+short Evaluation::scoreActivity( const Board& board, const Board::PieceBitboards& white, const Board::PieceBitboards& black )
+{
+    // Attacks for both sides are built once and shared between the mobility and king safety terms
+    unsigned long long occupancy = white.allMask() | black.allMask();
+
+    AttackMaps whiteAttacks;
+    AttackMaps blackAttacks;
+    makeAttackMaps( board, white, true, occupancy, pawnAttacks( black.pawnMask(), false ), whiteAttacks );
+    makeAttackMaps( board, black, false, occupancy, pawnAttacks( white.pawnMask(), true ), blackAttacks );
+
+    short score = whiteAttacks.mobility - blackAttacks.mobility;
+
+    score += scoreKingSafety( white, black, blackAttacks ) - scoreKingSafety( black, white, whiteAttacks );
+
+    return score;
+}
+
+const PawnHashTable::Entry& Evaluation::probePawnStructure( const Board& board, const Board::PieceBitboards& white, const Board::PieceBitboards& black )
+{
+    bool found;
+    PawnHashTable::Entry& entry = pawnHashTable.probe( board.getPawnKey(), &found );
+
+    if ( !found )
+    {
+        entry.key = board.getPawnKey();
+        entry.score = scorePawns( white.pawnMask(), black.pawnMask(), true, &entry.whitePassedPawns )
+                    - scorePawns( black.pawnMask(), white.pawnMask(), false, &entry.blackPassedPawns );
+    }
+
+    return entry;
+}
+
+unsigned long long Evaluation::pawnAttacks( unsigned long long pawns, bool isWhite )
+{
+    // Shift the whole set diagonally forwards, dropping anything that wraps around to the far file
+    const unsigned long long notFileA = ~Bitboard::getFileMask( 0 );
+    const unsigned long long notFileH = ~Bitboard::getFileMask( 7 );
+
+    return isWhite ? ( ( pawns << 7 ) & notFileH ) | ( ( pawns << 9 ) & notFileA )
+                   : ( ( pawns >> 9 ) & notFileH ) | ( ( pawns >> 7 ) & notFileA );
+}
+
+void Evaluation::makeAttackMaps( const Board& board, const Board::PieceBitboards& own, bool isWhite, unsigned long long occupancy, unsigned long long enemyPawnAttacks, AttackMaps& attacks )
+{
+    // Squares worth moving to - not blocked by our own pieces and not where a pawn can take us
+    unsigned long long mobilityArea = ~own.allMask() & ~enemyPawnAttacks;
+
+    attacks.pieceAttacks[ 1 ] = pawnAttacks( own.pawnMask(), isWhite );
+
+    unsigned short index;
+    unsigned long long pieces;
+
+    pieces = own.knightMask();
+    while ( Bitboard::getEachIndexForward( &index, pieces ) )
     {
-        unsigned char piece = board.pieceAt( index );
+        unsigned long long moves = Bitboard::getKnightMoves( index );
 
-        // Score this from one player's perspective, always
-        score += ( Piece::isColor( piece, color ) ? pieceWeights[ piece & 0b00000111 ] : -pieceWeights[ piece & 0b00000111 ] );
+        attacks.pieceAttacks[ 2 ] |= moves;
+        attacks.mobility += KNIGHT_MOBILITY_WEIGHT * std::popcount( moves & mobilityArea );
     }
 
-    // Placement
-    for ( int index = 0; index < 64; index++ )
+    pieces = own.bishopMask();
+    while ( Bitboard::getEachIndexForward( &index, pieces ) )
+    {
+        unsigned long long moves = board.bishopAttacks( index, occupancy );
+
+        attacks.pieceAttacks[ 3 ] |= moves;
+        attacks.mobility += BISHOP_MOBILITY_WEIGHT * std::popcount( moves & mobilityArea );
+    }
+
+    pieces = own.rookMask();
+    while ( Bitboard::getEachIndexForward( &index, pieces ) )
+    {
+        unsigned long long moves = board.rookAttacks( index, occupancy );
+
+        attacks.pieceAttacks[ 4 ] |= moves;
+        attacks.mobility += ROOK_MOBILITY_WEIGHT * std::popcount( moves & mobilityArea );
+    }
+
+    pieces = own.queenMask();
+    while ( Bitboard::getEachIndexForward( &index, pieces ) )
+    {
+        unsigned long long moves = board.bishopAttacks( index, occupancy ) | board.rookAttacks( index, occupancy );
+
+        attacks.pieceAttacks[ 5 ] |= moves;
+        attacks.mobility += QUEEN_MOBILITY_WEIGHT * std::popcount( moves & mobilityArea );
+    }
+
+    pieces = own.kingMask();
+    if ( Bitboard::getEachIndexForward( &index, pieces ) )
+    {
+        attacks.pieceAttacks[ 6 ] = Bitboard::getKingMoves( index );
+    }
+
+    attacks.allAttacks = attacks.pieceAttacks[ 1 ] | attacks.pieceAttacks[ 2 ] | attacks.pieceAttacks[ 3 ]
+                       | attacks.pieceAttacks[ 4 ] | attacks.pieceAttacks[ 5 ] | attacks.pieceAttacks[ 6 ];
+}
+
+short Evaluation::scoreKingSafety( const Board::PieceBitboards& own, const Board::PieceBitboards& enemy, const AttackMaps& enemyAttacks )
+{
+    unsigned short index;
+    unsigned long long king = own.kingMask();
+    if ( !Bitboard::getEachIndexForward( &index, king ) )
+    {
+        return 0;
+    }
+
+    // The king's square and those around it
+    unsigned long long kingZone = Bitboard::getKingMoves( index ) | own.kingMask();
+
+    short danger = 0;
+    for ( unsigned short piece = 1; piece <= 5; piece++ )
+    {
+        danger += kingZoneAttackWeights[ piece ] * std::popcount( kingZone & enemyAttacks.pieceAttacks[ piece ] );
+    }
+
+    if ( enemy.queenMask() == 0 )
+    {
+        danger /= KING_DANGER_SCALE_WITHOUT_QUEEN;
+    }
+
+    return -danger;
+}
+
+/// <summary>
+/// Score the pawn structure for one side: doubled, isolated, backward and passed pawns, and pawn chains
+/// </summary>
+/// <param name="ownPawns">the pawns to score</param>
+/// <param name="enemyPawns">the opposing pawns</param>
+/// <param name="isWhite">whether ownPawns are white</param>
+/// <param name="passedPawns">receives the bitboard of passed pawns</param>
+/// <returns>a centipawn score for ownPawns</returns>
+short Evaluation::scorePawns( unsigned long long ownPawns, unsigned long long enemyPawns, bool isWhite, unsigned long long* passedPawns )
+{
+    short score = 0;
+
+    *passedPawns = 0;
+
+    unsigned short index;
+    unsigned long long pawns = ownPawns;
+    while ( Bitboard::getEachIndexForward( &index, pawns ) )
     {
-        unsigned char piece = board.pieceAt( index );
+        unsigned short file = Utilities::indexToFile( index );
+        unsigned short rank = Utilities::indexToRank( index );
+
+        unsigned long long fileMask = Bitboard::getFileMask( index );
+        unsigned long long adjacentFiles = ( file > 0 ? fileMask >> 1 : 0 ) | ( file < 7 ? fileMask << 1 : 0 );
+
+        // Ranks ahead of this pawn, and ranks level with or behind it, from its own point of view
+        unsigned long long ahead = isWhite ? ( rank == 7 ? 0ull : ~0ull << ( ( rank + 1 ) << 3 ) ) : ( 1ull << ( rank << 3 ) ) - 1;
+        unsigned long long levelOrBehind = ~ahead;
+
+        // Doubled - only count the rearmost of a pair, so each extra pawn on a file is penalised once
+        if ( ownPawns & fileMask & ahead )
+        {
+            score -= DOUBLED_PAWN_PENALTY;
+        }
+
+        // Isolated - no friendly pawns on either neighbouring file
+        if ( ( ownPawns & adjacentFiles ) == 0 )
+        {
+            score -= ISOLATED_PAWN_PENALTY;
+        }
 
-        if ( ( piece & 0b00000111 ) == 0b00000001 ) // PAWN
+        // Backward - neighbours have all advanced beyond it and it cannot safely step up to join them
+        else if ( ahead != 0 && ( ownPawns & adjacentFiles & levelOrBehind ) == 0 )
         {
-            auto& advancement = Piece::isWhite( piece ) ? pawnAdvancementWhite : pawnAdvancementBlack;
+            unsigned short stopSquare = isWhite ? index + 8 : index - 8;
 
-            if ( !Piece::isColor( piece, board.activeColor ) )
+            if ( Bitboard::getPawnCaptures( stopSquare, isWhite ) & enemyPawns )
             {
-//                score += advancement[ Utilities::indexToRank( index ) ] * pawnAdvancementFile[ Utilities::indexToFile( index ) ];
+                score -= BACKWARD_PAWN_PENALTY;
             }
         }
+
+        // Passed - nothing can stop it on its own file or capture it from a neighbouring one
+        if ( ( enemyPawns & ( fileMask | adjacentFiles ) & ahead ) == 0 )
+        {
+            *passedPawns |= Bitboard::indexToBit( index );
+
+            score += isWhite ? pawnAdvancementWhite[ rank ] : pawnAdvancementBlack[ rank ];
+        }
+
+        // Chain - defended by a friendly pawn. The squares a pawn could be defended from are those
+        // an enemy pawn on this square would capture towards
+        if ( Bitboard::getPawnCaptures( index, !isWhite ) & ownPawns )
+        {
+            score += PAWN_CHAIN_BONUS;
+        }
     }
 
     return score;
 }
 
-short Evaluation::minimax( Board board, unsigned short depth, short alphaInput, short betaInput, bool maximising, unsigned char color )
+short Evaluation::scoreTerminal( Board& board, short result, unsigned short depth, unsigned char color )
 {
-    static const std::string spaces( "                                                                                                                  " );
-    
-    std::string space = spaces.substr( 0, depth * 2 );
+    // Why? Win (+1), Loss (-1) or Stalemate (0)
+    if ( result == 0 )
+    {
+        Log::Debug << "Score : 0" << std::endl;
+        return 0;
+    }
+
+    short score = result;
+    if ( board.getActiveColor() != color )
+    {
+        score = -score;
+    }
+
+    Log::Debug( [&] ( const Log::Logger logger )
+    {
+        logger << "Score: " << score << " Active color: " << Piece::toColorString( board.getActiveColor() ) << " Provided color: " << Piece::toColorString( color ) << std::endl;
+    } );
 
+    // Give it a critially large value, but not quite at lowest/highest...
+    // so we have some wiggle room so we can make one winning line seem preferable to another
+    score = score < 0 ? std::numeric_limits<short>::lowest() + 1000 : std::numeric_limits<short>::max() - 1000;
+
+    // Adjusting the return with the depth means that it'll chase shorter lines to terminal positions rather
+    // than just settling for a forced mate being something it can commit to at any time
+    if ( score < 0 )
+    {
+        score -= depth;
+    }
+    else
+    {
+        score += depth;
+    }
+
+    return score;
+}
+
+MoveOrdering& Evaluation::getMoveOrdering()
+{
+    return *moveOrdering;
+}
+
+void Evaluation::setMoveOrdering( MoveOrdering* ordering )
+{
+    moveOrdering = ordering;
+}
+
+PositionHistory& Evaluation::getPositionHistory()
+{
+    return positionHistory;
+}
+
+AccumulatorStack& Evaluation::getAccumulators()
+{
+    return accumulators;
+}
+
+short Evaluation::minimax( Board board, unsigned short depth, unsigned short ply, short alphaInput, short betaInput, bool maximising, unsigned char color, const Move& previousMove )
+{
     // Make some working values so we are not "editing" method parameters
     short alpha = alphaInput;
     short beta = betaInput;
 
+    statistics.nodes++;
+
     // If is win, return max
     // If is loss, return lowest
     // If draw, return 0
     // otherwise iterate
 
-    // Simple win semantics
+    // Draws by the fifty-move rule or repetition don't depend on depth. Within the search, a single repetition
+    // is scored as a draw, as whatever improvement the side to move could find, it could have found the first time
+    if ( positionHistory.isRepetition( board.getHashKey(), board.getHalfmoveClock() ) )
+    {
+        return 0;
+    }
+
+    // Mate delivered on the hundredth halfmove still wins, so only a side to move that is in check needs to
+    // look for a legal move before the fifty-move rule applies - stalemate is a draw either way
+    if ( board.getHalfmoveClock() >= 100 && !( board.isInCheck() && board.getMoves().empty() ) )
+    {
+        return 0;
+    }
+
     short score = 0;
-    if ( board.isTerminal( &score ) )
+    if ( depth == 0 )
     {
-        // Why? Win (+1), Loss (-1) or Stalemate (0)
-        if ( score == 0 )
+        statistics.leafNodes++;
+
+        // Simple win semantics
+        if ( board.isTerminal( &score ) )
         {
-            Log::Debug << "Score : 0" << std::endl;
-            return 0;
+            return scoreTerminal( board, score, depth, color );
         }
-        else
-        {
-            if ( board.getActiveColor() != color )
-            {
-                score = -score;
-            } 
-
-            Log::Debug( [&] ( const Log::Logger logger )
-            {
-                logger << "Score: " << score << " Active color: " << Piece::toColorString( board.getActiveColor() ) << " Provided color: " << Piece::toColorString( color ) << std::endl;
-            } );
-            
-            // Give it a critially large value, but not quite at lowest/highest...
-            // so we have some wiggle room so we can make one winning line seem preferable to another
-            score = score < 0 ? std::numeric_limits<short>::lowest() + 1000 : std::numeric_limits<short>::max() - 1000;
-
-            // Adjusting the return with the depth means that it'll chase shorter lines to terminal positions rather
-            // than just settling for a forced mate being something it can commit to at any time
-            if ( score < 0 )
-            {
-                score -= depth;
-            }
-            else
-            {
-                score += depth;
-            }
 
-            return score;
-        }
+        score = scorePosition( board, Network::isActive() ? &accumulators.get( ply ) : nullptr, color, alpha, beta );
+        return score;
     }
 
-    if ( depth == 0 )
+    // Interior nodes find out whether they are terminal from the move picker, which only generates
+    // as many moves as it takes to find a cutoff
+    Move hashMove = moveOrdering->getHashMove( board.getHashKey() );
+
+    statistics.hashMoveProbes++;
+    if ( !hashMove.isNullMove() )
     {
-        score = scorePosition( board, color );
-        return score;
+        statistics.hashMoveHits++;
     }
 
-    if ( maximising )
+    MovePicker picker( board,
+                       hashMove,
+                       moveOrdering->getKillers( ply ),
+                       previousMove.isNullMove() ? Move::nullMove : moveOrdering->getCounterMove( previousMove ) );
+
+    score = maximising ? std::numeric_limits<short>::lowest() : std::numeric_limits<short>::max();
+    Move bestMove = Move::nullMove;
+
+    positionHistory.push( board.getHashKey() );
+
+    int count = 0;
+    for ( Move move = picker.next(); !move.isNullMove(); move = picker.next() )
     {
-        score = std::numeric_limits<short>::lowest();
-        std::vector<Move> moves = board.getMoves();
+        count++;
 
-        int count = 0;
-        for ( std::vector<Move>::iterator it = moves.begin(); it != moves.end(); it++, count++ )
+        Board child = board.makeMove( move );
+        if ( Network::isActive() )
         {
-            short evaluation = minimax( board.makeMove( *( it ) ), depth - 1, alpha, beta, !maximising, color );
+            accumulators.update( ply, board, child, move );
+        }
+
+        short evaluation = minimax( child, depth - 1, ply + 1, alpha, beta, !maximising, color, move );
 
+        if ( maximising )
+        {
             if ( evaluation > score )
             {
                 score = evaluation;
+                bestMove = move;
             }
             if ( evaluation > alpha )
             {
                 alpha = evaluation;
             }
-            if ( beta <= alpha )
+        }
+        else
+        {
+            if ( evaluation < score )
             {
-                Log::Debug( [&] ( const Log::Logger& logger )
-                {
-                    logger << "Exiting maximising after " << count << "/" << moves.size() << " moves considered" << std::endl;
-                } );
-                break;
+                score = evaluation;
+                bestMove = move;
+            }
+            if ( evaluation < beta )
+            {
+                beta = evaluation;
             }
         }
 
-        return score;
-    }
-    else
-    {
-        score = std::numeric_limits<short>::max();
-        std::vector<Move> moves = board.getMoves();
-
-        int count = 0;
-        for ( std::vector<Move>::iterator it = moves.begin(); it != moves.end(); it++, count++ )
+        if ( beta <= alpha )
         {
-            short evaluation = minimax( board.makeMove( *( it ) ), depth - 1, alpha, beta, !maximising, color );
-
-            if ( evaluation < score )
+            statistics.betaCutoffs++;
+            if ( count == 1 )
             {
-                score = evaluation;
+                statistics.firstMoveCutoffs++;
             }
-            if ( evaluation < alpha )
+            if ( move == hashMove )
             {
-                alpha = evaluation;
+                statistics.hashMoveCutoffs++;
             }
-            if ( beta <= alpha )
+
+            // Quiet moves that refute a line are worth trying early in sibling positions, and against the same move elsewhere
+            if ( !move.isCapture() && !move.isPromotion() )
             {
-                Log::Debug( [&] ( const Log::Logger& logger )
+                moveOrdering->storeKiller( ply, move );
+
+                if ( !previousMove.isNullMove() )
                 {
-                    logger << "Exiting minimising after " << count << "/" << moves.size() << " moves considered" << std::endl;
-                } );
-                break;
+                    moveOrdering->storeCounterMove( previousMove, move );
+                }
             }
+
+            Log::Debug( [&] ( const Log::Logger& logger )
+            {
+                logger << "Exiting " << ( maximising ? "maximising" : "minimising" ) << " after " << count << " moves considered" << std::endl;
+            } );
+            break;
         }
+    }
 
-        return score;
+    positionHistory.pop();
+
+    if ( count == 0 )
+    {
+        return scoreTerminal( board, board.isInCheck() ? -1 : 0, depth, color );
     }
+
+    moveOrdering->storeHashMove( board.getHashKey(), bestMove );
+
+    return score;
 }
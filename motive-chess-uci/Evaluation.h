@@ -1,19 +1,221 @@
 #pragma once
 
+#include <limits>
+
+#include "AccumulatorStack.h"
 #include "Board.h"
+#include "EvaluationCache.h"
 #include "Move.h"
+#include "MoveOrdering.h"
+#include "Network.h"
+#include "PawnHashTable.h"
+#include "PositionHistory.h"
 
 class Evaluation
 {
 private:
+    // Pawn structure weights, in centipawns
+    inline static const short DOUBLED_PAWN_PENALTY = 15;
+    inline static const short ISOLATED_PAWN_PENALTY = 12;
+    inline static const short BACKWARD_PAWN_PENALTY = 8;
+    inline static const short PAWN_CHAIN_BONUS = 5;
+
+    // Bonus for each square a piece can reach that is neither occupied by its own side nor covered by enemy pawns
+    inline static const short KNIGHT_MOBILITY_WEIGHT = 4;
+    inline static const short BISHOP_MOBILITY_WEIGHT = 5;
+    inline static const short ROOK_MOBILITY_WEIGHT = 2;
+    inline static const short QUEEN_MOBILITY_WEIGHT = 1;
+
+    // The most that mobility and king safety are expected to move a score. Positions where material and
+    // pawn structure alone are further than this outside the alpha/beta window skip those terms
+    inline static const short LAZY_EVALUATION_MARGIN = 250;
+
+    // King danger is halved when the attacker has no queen, as few mating attacks succeed without one
+    inline static const short KING_DANGER_SCALE_WITHOUT_QUEEN = 2;
+
     static short pieceWeights[ 8 ];
+    static short kingZoneAttackWeights[ 8 ];
     static short pawnAdvancementWhite[ 8 ];
     static short pawnAdvancementBlack[ 8 ];
     static short pawnAdvancementFile[ 8 ];
 
+    /// <summary>
+    /// Squares attacked by one side's pieces, by piece type (indexed as the PieceBitboards masks),
+    /// and the mobility score gathered while building them
+    /// </summary>
+    class AttackMaps
+    {
+    public:
+        unsigned long long pieceAttacks[ 8 ];
+        unsigned long long allAttacks;
+        short mobility;
+
+        AttackMaps() :
+            allAttacks( 0 ),
+            mobility( 0 )
+        {
+            pieceAttacks[ 1 ] = pieceAttacks[ 2 ] = pieceAttacks[ 3 ] = pieceAttacks[ 4 ] = pieceAttacks[ 5 ] = pieceAttacks[ 6 ] = 0;
+        }
+    };
+
+    /// <summary>
+    /// Return the pawn structure details for this board, calculating them only if they are not
+    /// already in this thread's pawn hash table
+    /// </summary>
+    static const PawnHashTable::Entry& probePawnStructure( const Board& board, const Board::PieceBitboards& white, const Board::PieceBitboards& black );
+
+    static unsigned long long pawnAttacks( unsigned long long pawns, bool isWhite );
+
+    /// <summary>
+    /// Build the attack maps for one side, scoring mobility along the way
+    /// </summary>
+    /// <param name="board">the board</param>
+    /// <param name="own">the pieces to build attacks for</param>
+    /// <param name="isWhite">whether own pieces are white</param>
+    /// <param name="occupancy">all pieces on the board</param>
+    /// <param name="enemyPawnAttacks">squares attacked by the opposing pawns</param>
+    /// <param name="attacks">receives the attack maps</param>
+    static void makeAttackMaps( const Board& board, const Board::PieceBitboards& own, bool isWhite, unsigned long long occupancy, unsigned long long enemyPawnAttacks, AttackMaps& attacks );
+
+    /// <summary>
+    /// Penalise attacks on the squares around a king
+    /// </summary>
+    /// <param name="own">the pieces of the side whose king is being scored</param>
+    /// <param name="enemy">the opposing pieces</param>
+    /// <param name="enemyAttacks">the opposing attack maps</param>
+    /// <returns>a centipawn score for the side whose king is being scored</returns>
+    static short scoreKingSafety( const Board::PieceBitboards& own, const Board::PieceBitboards& enemy, const AttackMaps& enemyAttacks );
+
+    static short scorePawns( unsigned long long ownPawns, unsigned long long enemyPawns, bool isWhite, unsigned long long* passedPawns );
+
+    /// <summary>
+    /// The cheap, mostly incremental terms: material and (hashed) pawn structure
+    /// </summary>
+    /// <returns>a centipawn score from white's perspective</returns>
+    static short scoreMaterial( const Board& board, const Board::PieceBitboards& white, const Board::PieceBitboards& black );
+
+    /// <summary>
+    /// The expensive terms: mobility and king safety, from attack maps built here
+    /// </summary>
+    /// <returns>a centipawn score from white's perspective</returns>
+    static short scoreActivity( const Board& board, const Board::PieceBitboards& white, const Board::PieceBitboards& black );
+
+    /// <summary>
+    /// Score a position with no legal moves, or where the opponent's king can be taken
+    /// </summary>
+    /// <param name="result">the outcome for the active color, -1/0/+1</param>
+    static short scoreTerminal( Board& board, short result, unsigned short depth, unsigned char color );
+
 public:
-    static short scorePosition( Board board, unsigned char color );
+    /// <summary>
+    /// Evaluation and search counts for the calling thread
+    /// </summary>
+    class Statistics
+    {
+    public:
+        unsigned long long cacheProbes;
+        unsigned long long cacheHits;
+
+        // Evaluations cut short by the lazy evaluation margin
+        unsigned long long lazyExits;
+
+        // Positions searched, and those of them at the horizon, scored statically
+        unsigned long long nodes;
+        unsigned long long leafNodes;
+
+        // Cutoffs, and how many came from the first move tried - the higher the share, the better the ordering
+        unsigned long long betaCutoffs;
+        unsigned long long firstMoveCutoffs;
+
+        // Interior nodes that looked up a hash move, found one, and were cut off by it
+        unsigned long long hashMoveProbes;
+        unsigned long long hashMoveHits;
+        unsigned long long hashMoveCutoffs;
+
+        Statistics() :
+            cacheProbes( 0 ),
+            cacheHits( 0 ),
+            lazyExits( 0 ),
+            nodes( 0 ),
+            leafNodes( 0 ),
+            betaCutoffs( 0 ),
+            firstMoveCutoffs( 0 ),
+            hashMoveProbes( 0 ),
+            hashMoveHits( 0 ),
+            hashMoveCutoffs( 0 )
+        {
+            // Nothing to do
+        }
+    };
+
+    enum class Evaluator
+    {
+        CLASSIC,
+        NETWORK
+    };
+
+    /// <summary>
+    /// Choose how positions are scored. The network evaluator is only available if its weights loaded
+    /// </summary>
+    /// <param name="evaluator">the evaluator to use</param>
+    /// <returns>true if the requested evaluator is now in use</returns>
+    static bool setEvaluator( Evaluator evaluator );
+
+    static Evaluator getEvaluator()
+    {
+        return Network::isActive() ? Evaluator::NETWORK : Evaluator::CLASSIC;
+    }
+
+    /// <summary>
+    /// Size the evaluation cache shared by all search threads. Not safe to call while a search is running
+    /// </summary>
+    /// <param name="megabytes">the cache size, or zero to disable it</param>
+    static void setEvaluationCacheSize( size_t megabytes );
+
+    static void clearEvaluationCache();
+
+    static Statistics& getStatistics();
+
+    static short scorePosition( const Board& board, unsigned char color )
+    {
+        return scorePosition( board, nullptr, color, std::numeric_limits<short>::lowest(), std::numeric_limits<short>::max() );
+    }
+
+    static short scorePosition( const Board& board, const Network::Accumulator* accumulator, unsigned char color, short alpha, short beta );
+
+    /// <summary>
+    /// The move ordering knowledge of the calling thread's search
+    /// </summary>
+    static MoveOrdering& getMoveOrdering();
+
+    /// <summary>
+    /// Have the calling thread's searches use, and add to, the given move ordering knowledge
+    /// </summary>
+    static void setMoveOrdering( MoveOrdering* ordering );
+
+    /// <summary>
+    /// The positions before the calling thread's search node: the game's, then the search path's
+    /// </summary>
+    static PositionHistory& getPositionHistory();
+
+    /// <summary>
+    /// The network evaluator's first layer for each ply of the calling thread's search. The search's caller builds
+    /// the root's, and the search derives the rest from it as it makes moves
+    /// </summary>
+    static AccumulatorStack& getAccumulators();
 
-    static short minimax( Board board, unsigned short depth, short alpha, short beta, bool maximising, unsigned char color );
+    /// <summary>
+    /// Alpha-beta search, scored from a fixed perspective
+    /// </summary>
+    /// <param name="board">the position</param>
+    /// <param name="depth">the remaining depth</param>
+    /// <param name="ply">the distance from the root</param>
+    /// <param name="alpha">the lower bound</param>
+    /// <param name="beta">the upper bound</param>
+    /// <param name="maximising">whether color is to move</param>
+    /// <param name="color">the color to score for</param>
+    /// <param name="previousMove">the move that led to this position, or the null move</param>
+    /// <returns>the score</returns>
+    static short minimax( Board board, unsigned short depth, unsigned short ply, short alpha, short beta, bool maximising, unsigned char color, const Move& previousMove );
 };
 
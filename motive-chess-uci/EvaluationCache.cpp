@@ -0,0 +1,52 @@
+#include "EvaluationCache.h"
+
+#include <algorithm>
+#include <bit>
+
+#include "Log.h"
+
+void EvaluationCache::allocate( size_t megabytes )
+{
+    entries.reset();
+    mask = 0;
+
+    if ( megabytes == 0 )
+    {
+        return;
+    }
+
+    size_t count = std::bit_floor( ( std::min( megabytes, MAXIMUM_SIZE_MB ) << 20 ) / sizeof( Entry ) );
+
+    entries = std::make_unique<Entry[]>( count );
+    mask = count - 1;
+
+    clear();
+}
+
+void EvaluationCache::resize( size_t megabytes )
+{
+    allocate( megabytes );
+
+    if ( isEnabled() )
+    {
+        Log::Debug << "Evaluation cache sized to " << ( mask + 1 ) << " entries" << std::endl;
+    }
+    else
+    {
+        Log::Debug << "Evaluation cache disabled" << std::endl;
+    }
+}
+
+void EvaluationCache::clear()
+{
+    if ( !isEnabled() )
+    {
+        return;
+    }
+
+    for ( size_t index = 0; index <= mask; index++ )
+    {
+        entries[ index ].check.store( 0, std::memory_order_relaxed );
+        entries[ index ].data.store( 0, std::memory_order_relaxed );
+    }
+}
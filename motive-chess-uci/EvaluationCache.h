@@ -0,0 +1,91 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+
+/// <summary>
+/// A cache of static evaluations, keyed by Board's position hash key and shared by all search threads.
+/// Lockless: each entry stores its data alongside the key XOR'd with that data, so an entry torn by
+/// two threads writing at once fails the key check on the next probe rather than returning a bad score
+/// </summary>
+class EvaluationCache
+{
+public:
+    inline static const size_t DEFAULT_SIZE_MB = 4;
+    inline static const size_t MAXIMUM_SIZE_MB = 1024;
+
+private:
+    class Entry
+    {
+    public:
+        std::atomic<unsigned long long> check;
+        std::atomic<unsigned long long> data;
+    };
+
+    // Set in the stored data so that an empty entry never matches, even for a zero key
+    inline static const unsigned long long VALID = 1ull << 32;
+
+    std::unique_ptr<Entry[]> entries;
+    size_t mask;
+
+    void allocate( size_t megabytes );
+
+public:
+    EvaluationCache( size_t megabytes = DEFAULT_SIZE_MB ) :
+        mask( 0 )
+    {
+        // Quietly, as this may happen during static initialization, before logging is available
+        allocate( megabytes );
+    }
+
+    virtual ~EvaluationCache()
+    {
+        // Nothing to do
+    }
+
+    /// <summary>
+    /// Reallocate the cache, discarding its contents. Not safe to call while a search is running
+    /// </summary>
+    /// <param name="megabytes">the size of the cache, rounded down to a power of two entries, or zero to disable it</param>
+    void resize( size_t megabytes );
+
+    void clear();
+
+    inline bool isEnabled() const
+    {
+        return entries != nullptr;
+    }
+
+    /// <summary>
+    /// Look up a score
+    /// </summary>
+    /// <param name="key">a position hash key</param>
+    /// <param name="score">receives the cached score, if there is one</param>
+    /// <returns>true if the score was found</returns>
+    inline bool probe( unsigned long long key, short* score ) const
+    {
+        const Entry& entry = entries[ key & mask ];
+
+        unsigned long long data = entry.data.load( std::memory_order_relaxed );
+        unsigned long long check = entry.check.load( std::memory_order_relaxed );
+
+        if ( ( check ^ data ) != key || ( data & VALID ) == 0 )
+        {
+            return false;
+        }
+
+        *score = static_cast<short>( data & 0xFFFF );
+
+        return true;
+    }
+
+    inline void store( unsigned long long key, short score )
+    {
+        Entry& entry = entries[ key & mask ];
+
+        unsigned long long data = VALID | static_cast<unsigned short>( score );
+
+        entry.check.store( key ^ data, std::memory_order_relaxed );
+        entry.data.store( data, std::memory_order_relaxed );
+    }
+};
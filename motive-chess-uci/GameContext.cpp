@@ -1 +1,28 @@
 #include "GameContext.h"
+
+#include <algorithm>
+
+GameContext::GameContext( std::string_view fenString, const std::vector<Move>& moves ) :
+    fenString( fenString ),
+    board( Fen::fromPosition( this->fenString ) )
+{
+    for ( const Move& move : moves )
+    {
+        addMove( move );
+    }
+}
+
+bool GameContext::isContinuedBy( std::string_view fenString, const std::vector<Move>& moves ) const
+{
+    return fenString == this->fenString &&
+           moves.size() >= this->moves.size() &&
+           std::equal( this->moves.begin(), this->moves.end(), moves.begin() );
+}
+
+void GameContext::addMove( const Move& move )
+{
+    history.push( board.getHashKey() );
+    board = board.makeMove( move );
+
+    moves.push_back( move );
+}
@@ -1,35 +1,51 @@
 #pragma once
 
 #include <string>
+#include <string_view>
 #include <vector>
 
+#include "Board.h"
 #include "Fen.h"
 #include "Move.h"
+#include "PositionHistory.h"
 
 // Represents a specific, individual game within the UCI session
 
 class GameContext
 {
 private:
-    const Fen fen;
-    const std::vector<Move> moves;
+    const std::string fenString;
+    std::vector<Move> moves;
+
+    // The position after the moves, and the hash keys of those before it, kept up to date as moves are added
+    Board board;
+    PositionHistory history;
 
 public:
-    GameContext( Fen fen, std::vector<Move> moves ) :
-        fen( fen ),
-        moves( moves )
-    {
+    GameContext( std::string_view fenString, const std::vector<Move>& moves );
+
+    /// <summary>
+    /// Whether a position is this game carried on: the same starting position, and the same moves, plus any more
+    /// </summary>
+    /// <param name="fenString">the starting position</param>
+    /// <param name="moves">the moves from the starting position</param>
+    /// <returns>true if the game can be brought up to date by adding the extra moves</returns>
+    bool isContinuedBy( std::string_view fenString, const std::vector<Move>& moves ) const;
+
+    void addMove( const Move& move );
 
+    const std::vector<Move>& getMoves() const
+    {
+        return moves;
     }
 
-    const Fen& getFEN()
+    const Board& getBoard() const
     {
-        return fen;
+        return board;
     }
 
-    const std::vector<Move>& getMoves()
+    const PositionHistory& getHistory() const
     {
-        return moves;
+        return history;
     }
 };
-
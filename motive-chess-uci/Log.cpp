@@ -39,24 +39,40 @@ const char* Log::Destination::levelName( Log::Level level )
 
 std::string Log::Destination::timestamp()
 {
-    std::ostringstream timestamp;
+    return timestamp( std::chrono::system_clock::now() );
+}
 
-    std::chrono::system_clock::time_point now = std::chrono::system_clock::now();
-    auto ms = duration_cast<std::chrono::milliseconds>( now.time_since_epoch() ) % 1000;
+std::string Log::Destination::timestamp( std::chrono::system_clock::time_point now )
+{
+    // The time of day only changes once a second, so each thread keeps the last second it formatted, and only
+    // the milliseconds need writing in for each line
+    thread_local time_t cachedSecond = -1;
+    thread_local char timestamp[] = "HH:MM:SS.mmm";
 
-    // convert to std::time_t in order to convert to std::tm (broken time)
-    time_t timer = std::chrono::system_clock::to_time_t( now );
+    long long milliseconds = duration_cast<std::chrono::milliseconds>( now.time_since_epoch() ).count();
 
-    // convert to broken time
-    struct tm newtime;
-    localtime_s( &newtime, &timer );
+    // The system clock counts from the same epoch as std::time_t
+    time_t timer = static_cast<time_t>( milliseconds / 1000 );
+    if ( timer != cachedSecond )
+    {
+        // convert to broken time
+        struct tm newtime;
+        localtime_s( &newtime, &timer );
 
-    std::ostringstream oss;
+        // HH:MM:SS, after which strftime's terminator needs replacing with the separator
+        strftime( timestamp, 9, "%H:%M:%S", &newtime );
+        timestamp[ 8 ] = '.';
+
+        cachedSecond = timer;
+    }
 
-    timestamp << std::put_time( &newtime, "%H:%M:%S" ); // HH:MM:SS
-    timestamp << '.' << std::setfill( '0' ) << std::setw( 3 ) << ms.count();
+    unsigned int ms = static_cast<unsigned int>( milliseconds % 1000 );
+    timestamp[ 9 ] = static_cast<char>( '0' + ms / 100 );
+    timestamp[ 10 ] = static_cast<char>( '0' + ms / 10 % 10 );
+    timestamp[ 11 ] = static_cast<char>( '0' + ms % 10 );
 
-    return timestamp.str();
+    // Short enough for the small string optimisation, so no allocation
+    return std::string( timestamp, sizeof( timestamp ) - 1 );
 }
 
 // Log::Logger
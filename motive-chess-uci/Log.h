@@ -1,5 +1,6 @@
 #pragma once
 
+#include <chrono>
 #include <cstdarg>
 #include <cstdio>
 #include <fstream>
@@ -10,6 +11,18 @@
 #include <sstream>
 #include <string>
 #include <thread>
+#include <type_traits>
+
+// The lowest level of logging compiled in. Calls below it compile to nothing, whatever the level set at runtime,
+// so release builds pay nothing for the tracing in the move generation and search. Define LOG_MINIMUM_LEVEL as
+// one of the Log::Level names to override the default
+#ifndef LOG_MINIMUM_LEVEL
+#ifdef NDEBUG
+#define LOG_MINIMUM_LEVEL INFO
+#else
+#define LOG_MINIMUM_LEVEL TRACE
+#endif
+#endif
 
 extern std::mutex consoleLogMutex;
 extern std::mutex fileLogMutex;
@@ -23,11 +36,14 @@ public:
         TRACE, DEBUG, INFO, WARN, ERROR, NONE
     };
 
+    inline static constexpr Log::Level MINIMUM_LEVEL = Log::Level::LOG_MINIMUM_LEVEL;
+
     class Destination
     {
     protected:
         static const char* levelName( Log::Level level );
         static std::string timestamp();
+        static std::string timestamp( std::chrono::system_clock::time_point time );
 
         Log::Level level;
 
@@ -64,6 +80,23 @@ public:
         }
 
         virtual void write( Log::Level level, const char* message ) = 0;
+
+        /// <summary>
+        /// Write a message logged earlier, possibly by another thread, stamped with the time it was logged. Destinations
+        /// may hold it back until the next flush, so a batch of messages costs one flush rather than one each
+        /// </summary>
+        /// <param name="level">the level the message was logged at</param>
+        /// <param name="time">when the message was logged</param>
+        /// <param name="message">the message</param>
+        virtual void append( Log::Level level, [[maybe_unused]] std::chrono::system_clock::time_point time, const char* message )
+        {
+            write( level, message );
+        }
+
+        virtual void flush()
+        {
+            // Nothing to do here
+        }
     };
 
     class Logger
@@ -98,14 +131,15 @@ public:
             }
         }
 
-        typedef const std::function<void( const Log::Logger& logger )> LogCallback;
-
         // Calling syntax:
         //     Log::Error( [&] ( const Log::Logger& logger )
         //     {
         //         logger << "Benchmarking: " << ( benchmarking ? "on" : "off" ) << std::endl;
         //     } );
-        void operator()( LogCallback& logCallback ) const
+        //
+        // Taken as is, rather than wrapped in a std::function, so that nothing is built unless it is logged
+        template<typename LogCallback> requires std::is_invocable_v<const LogCallback&, const Log::Logger&>
+        void operator()( const LogCallback& logCallback ) const
         {
             if ( Log::isIncluded( level ) )
             {
@@ -178,36 +212,90 @@ public:
         friend class Log;
     };
 
-    inline static const Log::Logger Trace = Logger( Log::Level::TRACE );
-    inline static const Log::Logger Debug = Logger( Log::Level::DEBUG );
-    inline static const Log::Logger Info  = Logger( Log::Level::INFO );
-    inline static const Log::Logger Warn  = Logger( Log::Level::WARN );
-    inline static const Log::Logger Error = Logger( Log::Level::ERROR );
-
-    inline static const Log::Logger& logger( Log::Level level )
+    /// <summary>
+    /// Stands in for the loggers of levels below MINIMUM_LEVEL, taking the same calls and doing nothing with them,
+    /// so that they compile away. Arguments streamed to it are still evaluated, so anything costly to produce
+    /// belongs in a callback, which is never called
+    /// </summary>
+    class NullLogger
     {
-        switch ( level )
+    private:
+        constexpr NullLogger( Log::Level )
+        {
+            // Do nothing
+        }
+
+    public:
+        inline void operator()( const char*, ... ) const
         {
-            case Log::Level::TRACE:
-                return Log::Trace;
+            // Do nothing
+        }
+
+        inline void operator()( std::string& ) const
+        {
+            // Do nothing
+        }
+
+        template<typename LogCallback> requires std::is_invocable_v<const LogCallback&, const Log::Logger&>
+        inline void operator()( const LogCallback& ) const
+        {
+            // Do nothing
+        }
+
+        template<typename T>
+        inline const NullLogger& operator <<( const T& ) const
+        {
+            return *this;
+        }
+
+        inline const NullLogger& operator <<( decltype( std::endl<char, std::char_traits<char>> ) ) const
+        {
+            return *this;
+        }
+
+        inline const NullLogger& operator <<( decltype( std::hex ) ) const
+        {
+            return *this;
+        }
 
-            case Log::Level::DEBUG:
-                return Log::Debug;
+        inline const NullLogger& operator <<( decltype( std::setw ) ) const
+        {
+            return *this;
+        }
 
-            case Log::Level::INFO:
-                return Log::Info;
+        friend class Log;
+    };
 
-            case Log::Level::WARN:
-                return Log::Warn;
+    template<Log::Level level>
+    using LoggerFor = std::conditional_t<( level >= MINIMUM_LEVEL ), Log::Logger, Log::NullLogger>;
 
-            case Log::Level::ERROR:
-                return Log::Error;
+    inline static const LoggerFor<Log::Level::TRACE> Trace = LoggerFor<Log::Level::TRACE>( Log::Level::TRACE );
+    inline static const LoggerFor<Log::Level::DEBUG> Debug = LoggerFor<Log::Level::DEBUG>( Log::Level::DEBUG );
+    inline static const LoggerFor<Log::Level::INFO>  Info  = LoggerFor<Log::Level::INFO>( Log::Level::INFO );
+    inline static const LoggerFor<Log::Level::WARN>  Warn  = LoggerFor<Log::Level::WARN>( Log::Level::WARN );
+    inline static const LoggerFor<Log::Level::ERROR> Error = LoggerFor<Log::Level::ERROR>( Log::Level::ERROR );
 
-            case Log::Level::NONE:
-            default:
-                Log::Error( "Logger does not exist. Returning alternative." );
-                return Log::Error;
+    /// <summary>
+    /// The logger for a level chosen at runtime. Levels compiled out still have one, which logs nothing
+    /// </summary>
+    inline static const Log::Logger& logger( Log::Level level )
+    {
+        static const Log::Logger loggers[] =
+        {
+            Logger( Log::Level::TRACE ),
+            Logger( Log::Level::DEBUG ),
+            Logger( Log::Level::INFO ),
+            Logger( Log::Level::WARN ),
+            Logger( Log::Level::ERROR )
+        };
+
+        if ( level >= Log::Level::NONE )
+        {
+            Log::Error( "Logger does not exist. Returning alternative." );
+            level = Log::Level::ERROR;
         }
+
+        return loggers[ static_cast<int>( level ) ];
     }
 
     inline static void setDestination( Log::Destination* destination )
@@ -220,6 +308,14 @@ public:
         Log::destination = destination;
     }
 
+    /// <summary>
+    /// Stop logging without deleting the destination, for when something else is taking it over
+    /// </summary>
+    inline static void releaseDestination()
+    {
+        Log::destination = nullptr;
+    }
+
     inline static Log::Destination* getDestination() 
     {
         return Log::destination;
@@ -238,7 +334,7 @@ public:
     // Helper methods
     inline static bool isIncluded( Log::Level level )
     {
-        if ( Log::destination == nullptr )
+        if ( level < MINIMUM_LEVEL || Log::destination == nullptr )
         {
             return false;
         }
@@ -248,7 +344,7 @@ public:
 
     inline static bool isExcluded( Log::Level level )
     {
-        if ( Log::destination == nullptr )
+        if ( level < MINIMUM_LEVEL || Log::destination == nullptr )
         {
             return true;
         }
@@ -274,6 +370,18 @@ public:
         std::lock_guard<std::mutex> guard( consoleLogMutex );
         std::cerr << timestamp() << " " << levelName( level ) << " " << message << std::endl;
     }
+
+    inline void append( Log::Level level, std::chrono::system_clock::time_point time, const char* message ) override
+    {
+        std::lock_guard<std::mutex> guard( consoleLogMutex );
+        std::cerr << timestamp( time ) << " " << levelName( level ) << " " << message << '\n';
+    }
+
+    void flush() override
+    {
+        std::lock_guard<std::mutex> guard( consoleLogMutex );
+        std::cerr.flush();
+    }
 };
 
 class FileLogDestination : public Log::Destination
@@ -309,6 +417,20 @@ public:
         // TODO decide if we want this - might be costly
         stream.flush();
     }
+
+    inline void append( Log::Level level, std::chrono::system_clock::time_point time, const char* message ) override
+    {
+        std::lock_guard<std::mutex> guard( fileLogMutex );
+
+        stream << timestamp( time ) << " " << levelName( level ) << " " << message << '\n';
+    }
+
+    void flush() override
+    {
+        std::lock_guard<std::mutex> guard( fileLogMutex );
+
+        stream.flush();
+    }
 };
 
 class NullLogDestination : public Log::Destination
@@ -359,6 +481,18 @@ public:
         consoleLogDestination->write( level, message );
     }
 
+    inline void append( Log::Level level, std::chrono::system_clock::time_point time, const char* message ) override
+    {
+        fileLogDestination->append( level, time, message );
+        consoleLogDestination->append( level, time, message );
+    }
+
+    void flush() override
+    {
+        fileLogDestination->flush();
+        consoleLogDestination->flush();
+    }
+
     void setLevel( Log::Level level ) override
     {
         this->level = level;
@@ -1,4 +1,5 @@
-#include <sstream>
+#include <algorithm>
+#include <iterator>
 
 #include "Move.h"
 #include "Utilities.h"
@@ -27,32 +28,84 @@ Move::Move( unsigned short from,
 
 Move Move::fromString( const std::string& moveString )
 {
-    // Contains a promotion?
-    if ( moveString.length() > 4 )
+    return parseUci( moveString );
+}
+
+Move Move::parseUci( std::string_view moveString )
+{
+    if ( moveString.length() < 4 || moveString.length() > 5 )
     {
-        return Move::createBuilder( Utilities::squareToIndex( moveString.substr( 0, 2 ) ),
-                                    Utilities::squareToIndex( moveString.substr( 2, 2 ) ) )
-            .setPromotion( Piece::promotionPieceFromMoveString( moveString ) ).build();
+        return nullMove;
     }
 
-    return Move::createBuilder( Utilities::squareToIndex( moveString.substr( 0, 2 ) ),
-                                Utilities::squareToIndex( moveString.substr( 2, 2 ) ) )
-        .build();
+    // Support upper and lower case files, as squareToIndex does
+    auto toIndex = [] ( char file, char rank ) -> short
+    {
+        file = ( file >= 'A' && file <= 'H' ) ? file - 'A' + 'a' : file;
+
+        if ( file < 'a' || file > 'h' || rank < '1' || rank > '8' )
+        {
+            return -1;
+        }
+
+        return ( rank - '1' ) * 8 + ( file - 'a' );
+    };
+
+    short from = toIndex( moveString[ 0 ], moveString[ 1 ] );
+    short to = toIndex( moveString[ 2 ], moveString[ 3 ] );
+
+    if ( from < 0 || to < 0 )
+    {
+        return nullMove;
+    }
+
+    unsigned short bits = static_cast<unsigned short>( from | ( to << 6 ) );
+
+    if ( moveString.length() == 5 )
+    {
+        char letter = ( moveString[ 4 ] >= 'A' && moveString[ 4 ] <= 'Z' ) ? moveString[ 4 ] - 'A' + 'a' : moveString[ 4 ];
+
+        const char* found = std::find( std::begin( PROMOTION_LETTERS ), std::end( PROMOTION_LETTERS ), letter );
+        if ( found == std::end( PROMOTION_LETTERS ) )
+        {
+            return nullMove;
+        }
+
+        bits |= PROMOTION_BIT | static_cast<unsigned short>( ( found - PROMOTION_LETTERS ) << 12 );
+    }
+
+    return Move( bits );
 }
 
 std::string Move::toString() const
 {
-    std::stringstream stream;
+    char text[ UCI_BUFFER_SIZE ];
+
+    return std::string( text, toUci( text ) );
+}
 
+unsigned short Move::toUci( char out[ UCI_BUFFER_SIZE ] ) const
+{
     if ( isNullMove() )
     {
         // Special case for UCI
-        return "0000";
+        std::copy_n( "0000", 5, out );
+        return 4;
+    }
+
+    unsigned short length = 0;
+
+    out[ length++ ] = 'a' + ( getFrom() & 7 );
+    out[ length++ ] = '1' + ( getFrom() >> 3 );
+    out[ length++ ] = 'a' + ( getTo() & 7 );
+    out[ length++ ] = '1' + ( getTo() >> 3 );
+
+    if ( isPromotion() )
+    {
+        out[ length++ ] = PROMOTION_LETTERS[ ( moveBits & PROMOTION_MASK ) >> 12 ];
     }
 
-    stream << Utilities::indexToSquare( getFrom() )
-           << Utilities::indexToSquare( getTo() )
-           << Piece::toMoveString( getPromotionPiece( Piece::getStartingColor() ) ); // Color doesn't matter here
+    out[ length ] = '\0';
 
-    return stream.str();
+    return length;
 }
@@ -1,6 +1,8 @@
 #pragma once
 
 #include <string>
+#include <string_view>
+#include <type_traits>
 
 #include "Piece.h"
 
@@ -26,6 +28,9 @@ private:
     inline static const unsigned short PROMOTE_ROOK     = 0b1010000000000000;
     inline static const unsigned short PROMOTE_QUEEN    = 0b1011000000000000;
 
+    // UCI promotion letters, in the order of the promotion flags
+    inline static const char PROMOTION_LETTERS[ 4 ] = { 'n', 'b', 'r', 'q' };
+
     unsigned short moveBits;
     
     // Store everything in an unsigned int? 
@@ -112,22 +117,20 @@ public:
 
     static Move fromString( const std::string& moveString );
 
-    static const Move nullMove;
-
-    Move( Move& move ) :
-        moveBits( move.moveBits )
-    {
-    }
-
-    Move( const Move& move ) :
-        moveBits( move.moveBits )
-    {
-    }
+    /// <summary>
+    /// Parse a move in UCI long algebraic notation (e2e4, e7e8q) without allocating. Only the squares and any
+    /// promotion are set - Board::completeMove fills in the other flags for a particular position
+    /// </summary>
+    /// <param name="moveString">the move text</param>
+    /// <returns>the move, or the null move if the text isn't a move (including "0000")</returns>
+    static Move parseUci( std::string_view moveString );
 
-    virtual ~Move()
-    {
+    /// <summary>
+    /// Longest UCI move text, plus its terminator
+    /// </summary>
+    inline static const unsigned short UCI_BUFFER_SIZE = 6;
 
-    }
+    static const Move nullMove;
 
     inline bool operator == ( const Move& move ) const
     {
@@ -200,5 +203,16 @@ public:
     }
 
     std::string toString() const;
+
+    /// <summary>
+    /// Write the move in UCI long algebraic notation without allocating
+    /// </summary>
+    /// <param name="out">receives the null terminated text</param>
+    /// <returns>the length of the text</returns>
+    unsigned short toUci( char out[ UCI_BUFFER_SIZE ] ) const;
 };
 
+// Moves are copied around in bulk by move lists and tables, so keep them to the bare 16 bits, copyable as plain memory
+static_assert( sizeof( Move ) == 2 );
+static_assert( std::is_trivially_copyable_v<Move> && std::is_standard_layout_v<Move> );
+
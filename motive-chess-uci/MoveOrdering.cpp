@@ -0,0 +1,13 @@
+#include "MoveOrdering.h"
+
+void MoveOrdering::clear()
+{
+    std::fill( hashMoves.begin(), hashMoves.end(), HashMoveEntry() );
+    std::fill( killers.begin(), killers.end(), Move::nullMove );
+    std::fill( counterMoves.begin(), counterMoves.end(), Move::nullMove );
+}
+
+void MoveOrdering::clearKillers()
+{
+    std::fill( killers.begin(), killers.end(), Move::nullMove );
+}
@@ -0,0 +1,111 @@
+#pragma once
+
+#include <algorithm>
+#include <vector>
+
+#include "Move.h"
+
+/// <summary>
+/// Knowledge gathered during search that helps to try the best moves first: the best move last found
+/// in a position (keyed by Board's position hash), quiet moves that caused cutoffs at each ply (killers),
+/// and quiet moves that refuted each of the opponent's moves (counter-moves).
+/// Not thread safe - each search thread is expected to use its own
+/// </summary>
+class MoveOrdering
+{
+public:
+    inline static const unsigned short MAX_PLY = 128;
+    inline static const unsigned short KILLERS_PER_PLY = 2;
+
+private:
+    // Must be a power of two
+    inline static const size_t HASH_MOVES_SIZE = 65536;
+
+    class HashMoveEntry
+    {
+    public:
+        unsigned long long key;
+        Move move;
+
+        HashMoveEntry() :
+            key( 0 ),
+            move( Move::nullMove )
+        {
+            // Nothing to do
+        }
+    };
+
+    std::vector<HashMoveEntry> hashMoves;
+
+    // KILLERS_PER_PLY moves for each ply, most recent first
+    std::vector<Move> killers;
+
+    // Indexed by the from and to squares of the move being answered
+    std::vector<Move> counterMoves;
+
+public:
+    MoveOrdering() :
+        hashMoves( HASH_MOVES_SIZE ),
+        killers( MAX_PLY * KILLERS_PER_PLY, Move::nullMove ),
+        counterMoves( 64 * 64, Move::nullMove )
+    {
+        // Nothing to do
+    }
+
+    virtual ~MoveOrdering()
+    {
+        // Nothing to do
+    }
+
+    void clear();
+
+    /// <summary>
+    /// Forget the killers, which only make sense relative to the root of the search that found them
+    /// </summary>
+    void clearKillers();
+
+    inline Move getHashMove( unsigned long long key ) const
+    {
+        const HashMoveEntry& entry = hashMoves[ key & ( HASH_MOVES_SIZE - 1 ) ];
+
+        return entry.key == key ? entry.move : Move::nullMove;
+    }
+
+    inline void storeHashMove( unsigned long long key, const Move& move )
+    {
+        HashMoveEntry& entry = hashMoves[ key & ( HASH_MOVES_SIZE - 1 ) ];
+
+        entry.key = key;
+        entry.move = move;
+    }
+
+    /// <summary>
+    /// The killer moves for a ply, as an array of KILLERS_PER_PLY moves
+    /// </summary>
+    inline const Move* getKillers( unsigned short ply ) const
+    {
+        return &killers[ std::min<unsigned short>( ply, MAX_PLY - 1 ) * KILLERS_PER_PLY ];
+    }
+
+    inline void storeKiller( unsigned short ply, const Move& move )
+    {
+        Move* plyKillers = &killers[ std::min<unsigned short>( ply, MAX_PLY - 1 ) * KILLERS_PER_PLY ];
+
+        // Keep the killers distinct, so that a repeat offender doesn't push out the other one
+        if ( plyKillers[ 0 ] != move )
+        {
+            plyKillers[ 1 ] = plyKillers[ 0 ];
+            plyKillers[ 0 ] = move;
+        }
+    }
+
+    inline Move getCounterMove( const Move& previousMove ) const
+    {
+        return counterMoves[ ( previousMove.getFrom() << 6 ) + previousMove.getTo() ];
+    }
+
+    inline void storeCounterMove( const Move& previousMove, const Move& move )
+    {
+        counterMoves[ ( previousMove.getFrom() << 6 ) + previousMove.getTo() ] = move;
+    }
+};
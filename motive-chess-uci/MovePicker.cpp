@@ -0,0 +1,190 @@
+#include "MovePicker.h"
+
+#include "Bitboard.h"
+
+// Piece type occupies the low three bits of a piece, pawn (1) to king (6)
+static inline unsigned short pieceType( unsigned char piece )
+{
+    return piece & 0b00000111;
+}
+
+short MovePicker::scoreCapture( const Move& move ) const
+{
+    // An en passant capture lands on an empty square, but always takes a pawn
+    unsigned short victim = ( !move.isPromotion() && move.isEnPassantCapture() ) ? 1 : pieceType( board.pieceAt( move.getTo() ) );
+    unsigned short attacker = pieceType( board.pieceAt( move.getFrom() ) );
+
+    // Most valuable victim first, then least valuable attacker
+    short score = ( victim << 3 ) - attacker;
+
+    // Promotions (captures or not) are ordered alongside captures, by the piece gained
+    if ( move.isPromotion() )
+    {
+        score += pieceType( move.getPromotionPiece( board.activeColor ) ) << 3;
+    }
+
+    return score;
+}
+
+bool MovePicker::isGoodCapture( const Move& move ) const
+{
+    if ( move.isPromotion() || move.isEnPassantCapture() )
+    {
+        return true;
+    }
+
+    // Can't lose material taking something at least as valuable, nor taking something undefended
+    if ( pieceType( board.pieceAt( move.getTo() ) ) >= pieceType( board.pieceAt( move.getFrom() ) ) )
+    {
+        return true;
+    }
+
+    return !board.failsCheckTests( Bitboard::indexToBit( move.getTo() ), !Piece::isWhite( board.activeColor ) );
+}
+
+bool MovePicker::isPlayableQuiet( const Move& move ) const
+{
+    return !move.isNullMove() &&
+           !move.isCapture() &&
+           !move.isPromotion() &&
+           move != hashMove &&
+           board.isPseudoLegal( move ) &&
+           board.isLegal( move );
+}
+
+bool MovePicker::isAlreadyTried( const Move& move ) const
+{
+    return move == hashMove || move == killers[ 0 ] || move == killers[ 1 ] || move == counterMove;
+}
+
+Move MovePicker::next()
+{
+    while ( true )
+    {
+        switch ( stage )
+        {
+        case Stage::HASH_MOVE:
+            stage = Stage::GENERATE_CAPTURES;
+
+            if ( !hashMove.isNullMove() && board.isPseudoLegal( hashMove ) && board.isLegal( hashMove ) )
+            {
+                return hashMove;
+            }
+            break;
+
+        case Stage::GENERATE_CAPTURES:
+            board.getPseudoLegalMoves( Board::MoveGeneration::CAPTURES, moves );
+
+            scores.clear();
+            for ( const Move& move : moves )
+            {
+                scores.push_back( scoreCapture( move ) );
+            }
+
+            current = 0;
+            stage = Stage::GOOD_CAPTURES;
+            break;
+
+        case Stage::GOOD_CAPTURES:
+            while ( current < moves.size() )
+            {
+                // Selection sort, one move at a time, as a cutoff usually comes before the list is exhausted
+                size_t best = current;
+                for ( size_t index = current + 1; index < moves.size(); index++ )
+                {
+                    if ( scores[ index ] > scores[ best ] )
+                    {
+                        best = index;
+                    }
+                }
+                std::swap( moves[ current ], moves[ best ] );
+                std::swap( scores[ current ], scores[ best ] );
+
+                const Move& move = moves[ current++ ];
+
+                if ( move == hashMove )
+                {
+                    continue;
+                }
+
+                if ( !isGoodCapture( move ) )
+                {
+                    badCaptures.push_back( move );
+                    continue;
+                }
+
+                if ( board.isLegal( move ) )
+                {
+                    return move;
+                }
+            }
+
+            current = 0;
+            stage = Stage::KILLERS;
+            break;
+
+        case Stage::KILLERS:
+            while ( current < 2 )
+            {
+                const Move& killer = killers[ current++ ];
+
+                if ( ( current == 1 || killer != killers[ 0 ] ) && isPlayableQuiet( killer ) )
+                {
+                    return killer;
+                }
+            }
+
+            stage = Stage::COUNTER_MOVE;
+            break;
+
+        case Stage::COUNTER_MOVE:
+            stage = Stage::GENERATE_QUIETS;
+
+            if ( counterMove != killers[ 0 ] && counterMove != killers[ 1 ] && isPlayableQuiet( counterMove ) )
+            {
+                return counterMove;
+            }
+            break;
+
+        case Stage::GENERATE_QUIETS:
+            moves.clear();
+            board.getPseudoLegalMoves( Board::MoveGeneration::QUIETS, moves );
+
+            current = 0;
+            stage = Stage::QUIETS;
+            break;
+
+        case Stage::QUIETS:
+            while ( current < moves.size() )
+            {
+                const Move& move = moves[ current++ ];
+
+                if ( !isAlreadyTried( move ) && board.isLegal( move ) )
+                {
+                    return move;
+                }
+            }
+
+            current = 0;
+            stage = Stage::BAD_CAPTURES;
+            break;
+
+        case Stage::BAD_CAPTURES:
+            while ( current < badCaptures.size() )
+            {
+                const Move& move = badCaptures[ current++ ];
+
+                if ( board.isLegal( move ) )
+                {
+                    return move;
+                }
+            }
+
+            stage = Stage::DONE;
+            break;
+
+        case Stage::DONE:
+            return Move::nullMove;
+        }
+    }
+}
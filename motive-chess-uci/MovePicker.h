@@ -0,0 +1,84 @@
+#pragma once
+
+#include <vector>
+
+#include "Board.h"
+#include "Move.h"
+
+/// <summary>
+/// Hands out the legal moves of a position one at a time, best guesses first, generating each group of
+/// moves only when the previous groups are exhausted - so a cutoff on the hash move or a capture never
+/// pays for quiet move generation. The order is: hash move, winning and equal captures (most valuable victim,
+/// least valuable attacker), killers, counter-move, remaining quiet moves, then losing captures
+/// </summary>
+class MovePicker
+{
+private:
+    enum class Stage
+    {
+        HASH_MOVE,
+        GENERATE_CAPTURES,
+        GOOD_CAPTURES,
+        KILLERS,
+        COUNTER_MOVE,
+        GENERATE_QUIETS,
+        QUIETS,
+        BAD_CAPTURES,
+        DONE
+    };
+
+    Board& board;
+    const Move hashMove;
+    const Move killers[ 2 ];
+    const Move counterMove;
+
+    Stage stage;
+    std::vector<Move> moves;
+    std::vector<short> scores;
+    std::vector<Move> badCaptures;
+    size_t current;
+
+    short scoreCapture( const Move& move ) const;
+
+    bool isGoodCapture( const Move& move ) const;
+
+    /// <summary>
+    /// Whether a quiet move, hash, killer or counter-move from elsewhere can be played here, and hasn't already been tried
+    /// </summary>
+    bool isPlayableQuiet( const Move& move ) const;
+
+    /// <summary>
+    /// Whether a generated move was already handed out by one of the early stages
+    /// </summary>
+    bool isAlreadyTried( const Move& move ) const;
+
+public:
+    /// <summary>
+    /// Pick moves for a position
+    /// </summary>
+    /// <param name="board">the position, which must outlive the picker</param>
+    /// <param name="hashMove">the best move previously found for this position, or the null move</param>
+    /// <param name="killers">the killer moves for this ply, as an array of two moves (either may be the null move)</param>
+    /// <param name="counterMove">the move that last refuted the opponent's move, or the null move</param>
+    MovePicker( Board& board, const Move& hashMove, const Move* killers, const Move& counterMove ) :
+        board( board ),
+        hashMove( hashMove ),
+        killers{ killers[ 0 ], killers[ 1 ] },
+        counterMove( counterMove ),
+        stage( Stage::HASH_MOVE ),
+        current( 0 )
+    {
+        // Nothing to do
+    }
+
+    virtual ~MovePicker()
+    {
+        // Nothing to do
+    }
+
+    /// <summary>
+    /// The next legal move
+    /// </summary>
+    /// <returns>a move, or the null move when there are no more</returns>
+    Move next();
+};
@@ -0,0 +1,261 @@
+#include "Network.h"
+
+#include <algorithm>
+#include <cstring>
+#include <immintrin.h>
+#include <intrin.h>
+
+#include "Log.h"
+#include "NetworkAvx2.h"
+
+// Only the file mapping API is needed, and this keeps windows.h macros such as ERROR out of the way
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+
+bool Network::load( const std::string& filename )
+{
+    unload();
+
+    HANDLE file = ::CreateFileA( filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr );
+    if ( file == INVALID_HANDLE_VALUE )
+    {
+        Log::Info << "No network weights file found at " << filename << std::endl;
+        return false;
+    }
+
+    fileHandle = file;
+
+    LARGE_INTEGER size;
+    if ( !::GetFileSizeEx( file, &size ) )
+    {
+        Log::Error << "Failed to read size of network weights file " << filename << std::endl;
+        unload();
+        return false;
+    }
+
+    const size_t headerSize = 32;
+    const size_t expectedSize = headerSize
+                              + sizeof( short ) * HIDDEN
+                              + sizeof( short ) * INPUTS * HIDDEN
+                              + sizeof( int ) * DENSE
+                              + sizeof( short ) * DENSE * 2 * HIDDEN
+                              + sizeof( int ) * 8
+                              + sizeof( short ) * DENSE;
+
+    if ( static_cast<size_t>( size.QuadPart ) != expectedSize )
+    {
+        Log::Error << "Network weights file " << filename << " is " << size.QuadPart << " bytes, expected " << expectedSize << std::endl;
+        unload();
+        return false;
+    }
+
+    mappingHandle = ::CreateFileMappingA( file, nullptr, PAGE_READONLY, 0, 0, nullptr );
+    if ( mappingHandle == nullptr )
+    {
+        Log::Error << "Failed to map network weights file " << filename << std::endl;
+        unload();
+        return false;
+    }
+
+    view = ::MapViewOfFile( mappingHandle, FILE_MAP_READ, 0, 0, 0 );
+    if ( view == nullptr )
+    {
+        Log::Error << "Failed to view network weights file " << filename << std::endl;
+        unload();
+        return false;
+    }
+
+    // Check the header matches the network shape compiled into this build
+    const char* data = static_cast<const char*>( view );
+    int header[ 4 ];
+    std::memcpy( header, data + 4, sizeof( header ) );
+
+    if ( std::memcmp( data, "MCNN", 4 ) != 0 || header[ 0 ] != VERSION || header[ 1 ] != INPUTS || header[ 2 ] != HIDDEN || header[ 3 ] != DENSE )
+    {
+        Log::Error << "Network weights file " << filename << " does not match this network (version " << VERSION << ", "
+                   << INPUTS << "x" << HIDDEN << "x" << DENSE << ")" << std::endl;
+        unload();
+        return false;
+    }
+
+    // Weights are used in place, straight from the mapped view
+    data += headerSize;
+
+    featureBias = reinterpret_cast<const short*>( data );
+    data += sizeof( short ) * HIDDEN;
+
+    featureWeights = reinterpret_cast<const short*>( data );
+    data += sizeof( short ) * INPUTS * HIDDEN;
+
+    denseBias = reinterpret_cast<const int*>( data );
+    data += sizeof( int ) * DENSE;
+
+    denseWeights = reinterpret_cast<const short*>( data );
+    data += sizeof( short ) * DENSE * 2 * HIDDEN;
+
+    outputBias = reinterpret_cast<const int*>( data );
+    data += sizeof( int ) * 8;
+
+    outputWeights = reinterpret_cast<const short*>( data );
+
+    loaded = true;
+    avx2 = supportsAvx2();
+
+    Log::Info << "Loaded network weights from " << filename << ( avx2 ? ", using AVX2" : "" ) << std::endl;
+
+    return true;
+}
+
+void Network::unload()
+{
+    loaded = false;
+    active = false;
+
+    if ( view != nullptr )
+    {
+        ::UnmapViewOfFile( view );
+        view = nullptr;
+    }
+
+    if ( mappingHandle != nullptr )
+    {
+        ::CloseHandle( mappingHandle );
+        mappingHandle = nullptr;
+    }
+
+    if ( fileHandle != nullptr )
+    {
+        ::CloseHandle( fileHandle );
+        fileHandle = nullptr;
+    }
+
+    featureBias = nullptr;
+    featureWeights = nullptr;
+    denseBias = nullptr;
+    denseWeights = nullptr;
+    outputBias = nullptr;
+    outputWeights = nullptr;
+}
+
+bool Network::setActive( bool active )
+{
+    // Can't use the network without any weights
+    Network::active = active && loaded;
+
+    return Network::active;
+}
+
+void Network::resetAccumulator( Accumulator& accumulator )
+{
+    for ( unsigned short perspective = 0; perspective < 2; perspective++ )
+    {
+        std::copy( featureBias, featureBias + HIDDEN, accumulator.values[ perspective ] );
+    }
+}
+
+bool Network::supportsAvx2()
+{
+    int info[ 4 ];
+
+    __cpuid( info, 0 );
+    if ( info[ 0 ] < 7 )
+    {
+        return false;
+    }
+
+    // The processor must support AVX, and the operating system must save the AVX registers on a context switch
+    __cpuid( info, 1 );
+    const int osxsave = 1 << 27;
+    const int avx = 1 << 28;
+    if ( ( info[ 2 ] & ( osxsave | avx ) ) != ( osxsave | avx ) || ( _xgetbv( 0 ) & 0b110 ) != 0b110 )
+    {
+        return false;
+    }
+
+    __cpuidex( info, 7, 0 );
+    return ( info[ 1 ] & ( 1 << 5 ) ) != 0;
+}
+
+/// <summary>
+/// Integer dot product of two int16 vectors. Length must be a multiple of 16
+/// </summary>
+int Network::dot( const short* a, const short* b, unsigned short length )
+{
+    if ( avx2 )
+    {
+        return NetworkAvx2::dot( a, b, length );
+    }
+
+#if defined( __SSE4_1__ ) || defined( __AVX__ )
+    __m128i sum = _mm_setzero_si128();
+    for ( unsigned short loop = 0; loop < length; loop += 8 )
+    {
+        __m128i va = _mm_loadu_si128( reinterpret_cast<const __m128i*>( a + loop ) );
+        __m128i vb = _mm_loadu_si128( reinterpret_cast<const __m128i*>( b + loop ) );
+
+        sum = _mm_add_epi32( sum, _mm_madd_epi16( va, vb ) );
+    }
+
+    sum = _mm_hadd_epi32( sum, sum );
+    sum = _mm_hadd_epi32( sum, sum );
+    return _mm_cvtsi128_si32( sum );
+#else
+    int sum = 0;
+    for ( unsigned short loop = 0; loop < length; loop++ )
+    {
+        sum += a[ loop ] * b[ loop ];
+    }
+
+    return sum;
+#endif
+}
+
+short Network::evaluate( const Accumulator& accumulator, bool whiteToMove )
+{
+    // Side to move first, then the opponent, each clipped to the activation range
+    alignas( 32 ) short input[ 2 * HIDDEN ];
+
+    const short* us = accumulator.values[ whiteToMove ? 0 : 1 ];
+    const short* them = accumulator.values[ whiteToMove ? 1 : 0 ];
+
+    if ( avx2 )
+    {
+        NetworkAvx2::activate( us, them, input, HIDDEN, ACTIVATION_MAX );
+    }
+    else
+    {
+#if defined( __SSE4_1__ ) || defined( __AVX__ )
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i ceiling = _mm_set1_epi16( ACTIVATION_MAX );
+        for ( unsigned short loop = 0; loop < HIDDEN; loop += 8 )
+        {
+            __m128i vus = _mm_load_si128( reinterpret_cast<const __m128i*>( us + loop ) );
+            __m128i vthem = _mm_load_si128( reinterpret_cast<const __m128i*>( them + loop ) );
+
+            _mm_store_si128( reinterpret_cast<__m128i*>( input + loop ), _mm_min_epi16( _mm_max_epi16( vus, zero ), ceiling ) );
+            _mm_store_si128( reinterpret_cast<__m128i*>( input + HIDDEN + loop ), _mm_min_epi16( _mm_max_epi16( vthem, zero ), ceiling ) );
+        }
+#else
+        for ( unsigned short loop = 0; loop < HIDDEN; loop++ )
+        {
+            input[ loop ] = std::clamp<short>( us[ loop ], 0, ACTIVATION_MAX );
+            input[ HIDDEN + loop ] = std::clamp<short>( them[ loop ], 0, ACTIVATION_MAX );
+        }
+#endif
+    }
+
+    // Hidden dense layer
+    alignas( 32 ) short hidden[ DENSE ];
+    for ( unsigned short neuron = 0; neuron < DENSE; neuron++ )
+    {
+        int value = denseBias[ neuron ] + dot( input, denseWeights + neuron * 2 * HIDDEN, 2 * HIDDEN );
+
+        hidden[ neuron ] = static_cast<short>( std::clamp( value >> DENSE_SHIFT, 0, static_cast<int>( ACTIVATION_MAX ) ) );
+    }
+
+    // Output
+    int output = *outputBias + dot( hidden, outputWeights, DENSE );
+
+    return static_cast<short>( std::clamp( output >> OUTPUT_SHIFT, -30000, 30000 ) );
+}
@@ -0,0 +1,149 @@
+#pragma once
+
+#include <string>
+
+/// <summary>
+/// An efficiently updatable neural network evaluator.
+///
+/// Inputs are simple piece-square features (color, piece type and square, so 2 x 6 x 64) seen from
+/// each side's perspective. The first layer is an int16 accumulator per perspective that the search keeps
+/// up to date, ply by ply, by adding and subtracting feature weights as moves place and remove pieces. The dense
+/// layers that follow are evaluated from scratch, with AVX2 kernels if the processor supports them, and
+/// otherwise with SSE or scalar code, according to the build.
+///
+/// Weights are memory mapped from a file with this little-endian layout:
+///     char    magic[ 4 ]                      "MCNN"
+///     int32   version, inputs, hidden, dense  must match the constants below
+///     int32   padding[ 3 ]                    keeps the arrays that follow 32-byte aligned
+///     int16   featureBias[ HIDDEN ]
+///     int16   featureWeights[ INPUTS ][ HIDDEN ]
+///     int32   denseBias[ DENSE ]
+///     int16   denseWeights[ DENSE ][ 2 * HIDDEN ]
+///     int32   outputBias
+///     int32   padding[ 7 ]
+///     int16   outputWeights[ DENSE ]
+/// </summary>
+class Network
+{
+public:
+    inline static const unsigned short INPUTS = 768;
+    inline static const unsigned short HIDDEN = 128;
+    inline static const unsigned short DENSE = 32;
+
+    inline static const int VERSION = 1;
+
+    // Activations are clipped to [0, ACTIVATION_MAX] and the dense layers are scaled down by these shifts
+    inline static const short ACTIVATION_MAX = 127;
+    inline static const int DENSE_SHIFT = 6;
+    inline static const int OUTPUT_SHIFT = 6;
+
+    /// <summary>
+    /// First layer outputs, one set for each perspective (0 for white, 1 for black)
+    /// </summary>
+    class Accumulator
+    {
+    public:
+        alignas( 32 ) short values[ 2 ][ HIDDEN ];
+    };
+
+private:
+    inline static bool loaded = false;
+    inline static bool active = false;
+
+    // Whether the processor can run the AVX2 kernels, found when the weights are loaded
+    inline static bool avx2 = false;
+
+    inline static const short* featureBias = nullptr;
+    inline static const short* featureWeights = nullptr;
+    inline static const int* denseBias = nullptr;
+    inline static const short* denseWeights = nullptr;
+    inline static const int* outputBias = nullptr;
+    inline static const short* outputWeights = nullptr;
+
+    // Handles for the memory mapped weights file, held for the life of the process
+    inline static void* fileHandle = nullptr;
+    inline static void* mappingHandle = nullptr;
+    inline static const void* view = nullptr;
+
+    inline static unsigned short featureIndex( unsigned char piece, unsigned short index, unsigned short perspective )
+    {
+        // Piece colors are 0b01000 and 0b10000, piece types 1-6. Flip color and rank for black's perspective
+        unsigned short color = ( ( piece >> 4 ) & 1 ) ^ perspective;
+        unsigned short square = perspective ? index ^ 56 : index;
+
+        return ( ( color * 6 + ( piece & 0b00000111 ) - 1 ) << 6 ) + square;
+    }
+
+    static int dot( const short* a, const short* b, unsigned short length );
+
+    static bool supportsAvx2();
+
+    static void unload();
+
+public:
+    /// <summary>
+    /// Memory map the weights from a file
+    /// </summary>
+    /// <param name="filename">the weights file</param>
+    /// <returns>true if the network is ready for use</returns>
+    static bool load( const std::string& filename );
+
+    static void shutdown()
+    {
+        unload();
+    }
+
+    inline static bool isLoaded()
+    {
+        return loaded;
+    }
+
+    /// <summary>
+    /// Searches only maintain accumulators while the network is active, so that the classic
+    /// evaluator does not pay for them
+    /// </summary>
+    inline static bool isActive()
+    {
+        return active;
+    }
+
+    static bool setActive( bool active );
+
+    static void resetAccumulator( Accumulator& accumulator );
+
+    inline static void addPiece( Accumulator& accumulator, unsigned char piece, unsigned short index )
+    {
+        for ( unsigned short perspective = 0; perspective < 2; perspective++ )
+        {
+            const short* weights = featureWeights + featureIndex( piece, index, perspective ) * HIDDEN;
+            short* values = accumulator.values[ perspective ];
+
+            for ( unsigned short loop = 0; loop < HIDDEN; loop++ )
+            {
+                values[ loop ] += weights[ loop ];
+            }
+        }
+    }
+
+    inline static void removePiece( Accumulator& accumulator, unsigned char piece, unsigned short index )
+    {
+        for ( unsigned short perspective = 0; perspective < 2; perspective++ )
+        {
+            const short* weights = featureWeights + featureIndex( piece, index, perspective ) * HIDDEN;
+            short* values = accumulator.values[ perspective ];
+
+            for ( unsigned short loop = 0; loop < HIDDEN; loop++ )
+            {
+                values[ loop ] -= weights[ loop ];
+            }
+        }
+    }
+
+    /// <summary>
+    /// Run the dense layers over an up-to-date accumulator
+    /// </summary>
+    /// <param name="accumulator">the accumulator for the position</param>
+    /// <param name="whiteToMove">which perspective goes first</param>
+    /// <returns>a centipawn score from the perspective of the side to move</returns>
+    static short evaluate( const Accumulator& accumulator, bool whiteToMove );
+};
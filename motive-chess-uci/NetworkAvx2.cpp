@@ -0,0 +1,35 @@
+#include "NetworkAvx2.h"
+
+#include <immintrin.h>
+
+int NetworkAvx2::dot( const short* a, const short* b, unsigned short length )
+{
+    __m256i sum = _mm256_setzero_si256();
+    for ( unsigned short loop = 0; loop < length; loop += 16 )
+    {
+        __m256i va = _mm256_loadu_si256( reinterpret_cast<const __m256i*>( a + loop ) );
+        __m256i vb = _mm256_loadu_si256( reinterpret_cast<const __m256i*>( b + loop ) );
+
+        // Multiplies pairs of int16s and adds adjacent products into int32s
+        sum = _mm256_add_epi32( sum, _mm256_madd_epi16( va, vb ) );
+    }
+
+    __m128i half = _mm_add_epi32( _mm256_castsi256_si128( sum ), _mm256_extracti128_si256( sum, 1 ) );
+    half = _mm_hadd_epi32( half, half );
+    half = _mm_hadd_epi32( half, half );
+    return _mm_cvtsi128_si32( half );
+}
+
+void NetworkAvx2::activate( const short* us, const short* them, short* input, unsigned short length, short ceiling )
+{
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i top = _mm256_set1_epi16( ceiling );
+    for ( unsigned short loop = 0; loop < length; loop += 16 )
+    {
+        __m256i vus = _mm256_load_si256( reinterpret_cast<const __m256i*>( us + loop ) );
+        __m256i vthem = _mm256_load_si256( reinterpret_cast<const __m256i*>( them + loop ) );
+
+        _mm256_store_si256( reinterpret_cast<__m256i*>( input + loop ), _mm256_min_epi16( _mm256_max_epi16( vus, zero ), top ) );
+        _mm256_store_si256( reinterpret_cast<__m256i*>( input + length + loop ), _mm256_min_epi16( _mm256_max_epi16( vthem, zero ), top ) );
+    }
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+/// <summary>
+/// The network evaluator's AVX2 kernels. This is the only file built with AVX2 enabled, so that the rest of
+/// the engine still runs on processors without it. Network only calls these once it has found the processor
+/// supports AVX2
+/// </summary>
+class NetworkAvx2
+{
+public:
+    /// <summary>
+    /// Integer dot product of two int16 vectors. Length must be a multiple of 16
+    /// </summary>
+    static int dot( const short* a, const short* b, unsigned short length );
+
+    /// <summary>
+    /// Clip both perspectives of the accumulator to [0, ceiling], side to move first. All three arrays must be
+    /// 32-byte aligned, and length a multiple of 16
+    /// </summary>
+    /// <param name="us">the accumulator values for the side to move</param>
+    /// <param name="them">the accumulator values for the opponent</param>
+    /// <param name="input">receives length values for us, then length for them</param>
+    /// <param name="length">the number of values in each perspective</param>
+    /// <param name="ceiling">the largest activation</param>
+    static void activate( const short* us, const short* them, short* input, unsigned short length, short ceiling );
+};
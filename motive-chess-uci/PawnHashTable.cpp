@@ -0,0 +1,11 @@
+#include "PawnHashTable.h"
+
+#include <algorithm>
+
+void PawnHashTable::clear()
+{
+    std::fill( entries.begin(), entries.end(), Entry() );
+
+    probes = 0;
+    hits = 0;
+}
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+/// <summary>
+/// A cache of pawn structure evaluations, keyed by Board's pawn hash key.
+/// Pawn structure barely changes between sibling nodes in the search, so most lookups hit.
+/// Not thread safe - each search thread is expected to use its own table
+/// </summary>
+class PawnHashTable
+{
+public:
+    class Entry
+    {
+    public:
+        unsigned long long key;
+
+        // Passed pawns for white and black, for use by other evaluation terms
+        unsigned long long whitePassedPawns;
+        unsigned long long blackPassedPawns;
+
+        // Pawn structure score from white's perspective
+        short score;
+
+        Entry() :
+            key( 0 ),
+            whitePassedPawns( 0 ),
+            blackPassedPawns( 0 ),
+            score( 0 )
+        {
+            // Nothing to do
+        }
+    };
+
+private:
+    // Must be a power of two
+    inline static const size_t DEFAULT_SIZE = 8192;
+
+    std::vector<Entry> entries;
+    size_t mask;
+
+    unsigned long long probes;
+    unsigned long long hits;
+
+public:
+    PawnHashTable( size_t size = DEFAULT_SIZE ) :
+        entries( size ),
+        mask( size - 1 ),
+        probes( 0 ),
+        hits( 0 )
+    {
+        // Nothing to do
+    }
+
+    virtual ~PawnHashTable()
+    {
+        // Nothing to do
+    }
+
+    /// <summary>
+    /// Look up the entry slot for a pawn key. The caller should check whether the key matches
+    /// and, if not, fill in the entry with fresh values
+    /// </summary>
+    /// <param name="key">a pawn hash key</param>
+    /// <param name="found">set to true if the entry already holds values for this key</param>
+    /// <returns>the entry for this key</returns>
+    inline Entry& probe( unsigned long long key, bool* found )
+    {
+        Entry& entry = entries[ key & mask ];
+
+        probes++;
+
+        // A freshly cleared entry matches the zero key, which is fine as that means no pawns at all,
+        // and no pawns means no score and no passed pawns
+        *found = entry.key == key;
+
+        if ( *found )
+        {
+            hits++;
+        }
+
+        return entry;
+    }
+
+    void clear();
+
+    inline unsigned long long getProbes() const
+    {
+        return probes;
+    }
+
+    inline unsigned long long getHits() const
+    {
+        return hits;
+    }
+};
@@ -0,0 +1,96 @@
+#include "PerftReport.h"
+
+#include "Log.h"
+
+PerftReport::PerftReport( const std::string& filename ) :
+    format( filename.ends_with( ".json" ) ? Format::JSON : Format::CSV ),
+    empty( true )
+{
+    stream.open( filename, std::ios::out );
+
+    if ( !stream.is_open() )
+    {
+        Log::Error << "Failed to open perft report " << filename << std::endl;
+        return;
+    }
+
+    if ( format == Format::JSON )
+    {
+        stream << "[";
+    }
+    else
+    {
+        stream << "fen,depth,expected,nodes,result,seconds,nps" << std::endl;
+    }
+}
+
+PerftReport::~PerftReport()
+{
+    if ( stream.is_open() )
+    {
+        if ( format == Format::JSON )
+        {
+            stream << ( empty ? "]" : "\n]" ) << std::endl;
+        }
+
+        stream.close();
+    }
+}
+
+std::string PerftReport::escape( const std::string& text )
+{
+    std::string escaped;
+    for ( char c : text )
+    {
+        if ( c == '"' || c == '\\' )
+        {
+            escaped.push_back( '\\' );
+        }
+        escaped.push_back( c );
+    }
+
+    return escaped;
+}
+
+void PerftReport::add( const std::string& fen, unsigned int depth, long long expected, unsigned long long nodes, std::chrono::steady_clock::duration elapsed )
+{
+    if ( !stream.is_open() )
+    {
+        return;
+    }
+
+    double seconds = std::chrono::duration<double>( elapsed ).count();
+    unsigned long long nps = seconds == 0 ? 0 : static_cast<unsigned long long>( nodes / seconds );
+
+    const char* result = expected == NO_EXPECTATION ? "none" : ( static_cast<unsigned long long>( expected ) == nodes ? "pass" : "fail" );
+
+    if ( format == Format::JSON )
+    {
+        stream << ( empty ? "\n" : ",\n" )
+               << "{\"fen\":\"" << escape( fen ) << "\",\"depth\":" << depth << ",\"expected\":";
+
+        if ( expected == NO_EXPECTATION )
+        {
+            stream << "null";
+        }
+        else
+        {
+            stream << expected;
+        }
+
+        stream << ",\"nodes\":" << nodes << ",\"result\":\"" << result << "\",\"seconds\":" << seconds << ",\"nps\":" << nps << "}";
+    }
+    else
+    {
+        stream << "\"" << fen << "\"," << depth << ",";
+
+        if ( expected != NO_EXPECTATION )
+        {
+            stream << expected;
+        }
+
+        stream << "," << nodes << "," << result << "," << seconds << "," << nps << std::endl;
+    }
+
+    empty = false;
+}
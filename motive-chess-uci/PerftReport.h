@@ -0,0 +1,54 @@
+#pragma once
+
+#include <chrono>
+#include <fstream>
+#include <string>
+
+/// <summary>
+/// A machine readable record of a perft run, one entry per position and depth, for feeding into dashboards.
+/// Written as JSON if the filename ends in .json, and as CSV otherwise
+/// </summary>
+class PerftReport
+{
+public:
+    enum class Format
+    {
+        CSV,
+        JSON
+    };
+
+    // Stands in for the expected count when there isn't one
+    inline static const long long NO_EXPECTATION = -1;
+
+private:
+    std::ofstream stream;
+    Format format;
+
+    // Whether an entry has been written yet, as JSON entries need separating
+    bool empty;
+
+    static std::string escape( const std::string& text );
+
+public:
+    PerftReport( const std::string& filename );
+
+    /// <summary>
+    /// Closes off the report
+    /// </summary>
+    virtual ~PerftReport();
+
+    inline bool isOpen() const
+    {
+        return stream.is_open();
+    }
+
+    /// <summary>
+    /// Add the outcome of one perft count
+    /// </summary>
+    /// <param name="fen">the position counted from</param>
+    /// <param name="depth">the depth counted to</param>
+    /// <param name="expected">the count expected, or NO_EXPECTATION</param>
+    /// <param name="nodes">the count</param>
+    /// <param name="elapsed">how long counting took</param>
+    void add( const std::string& fen, unsigned int depth, long long expected, unsigned long long nodes, std::chrono::steady_clock::duration elapsed );
+};
@@ -71,6 +71,12 @@ public:
         return isWhite( color ) ? WPROMOTION : BPROMOTION;
     }
 
+    template<bool isWhite>
+    inline static const unsigned char* getPromotionPieces()
+    {
+        return isWhite ? WPROMOTION : BPROMOTION;
+    }
+
     /// <summary>
     /// Return a lowercase letter representing the provided piece. Useful for 
     /// generating a UCI moves list
@@ -170,6 +176,12 @@ public:
         return color == WHITE ? WKING : BKING;
     }
 
+    template<bool isWhite>
+    inline static constexpr unsigned char ownKingPiece()
+    {
+        return isWhite ? WKING : BKING;
+    }
+
     inline static unsigned char enemyKingPiece( unsigned char color )
     {
         return color == WHITE ? BKING : WKING;
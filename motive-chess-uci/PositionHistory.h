@@ -0,0 +1,69 @@
+#pragma once
+
+#include <algorithm>
+#include <vector>
+
+/// <summary>
+/// The hash keys of the positions leading up to the one being considered - those of the game so far,
+/// followed by those along the current search path - for spotting repetitions.
+/// Not thread safe - each search thread is expected to use its own
+/// </summary>
+class PositionHistory
+{
+private:
+    std::vector<unsigned long long> keys;
+
+public:
+    PositionHistory()
+    {
+        // Game plus search path rarely gets near this, so pushes won't usually reallocate
+        keys.reserve( 1024 );
+    }
+
+    virtual ~PositionHistory()
+    {
+        // Nothing to do
+    }
+
+    inline void clear()
+    {
+        keys.clear();
+    }
+
+    inline void push( unsigned long long key )
+    {
+        keys.push_back( key );
+    }
+
+    inline void pop()
+    {
+        keys.pop_back();
+    }
+
+    inline size_t size() const
+    {
+        return keys.size();
+    }
+
+    /// <summary>
+    /// Whether a position has occurred before. Only positions with the same side to move can match, so every
+    /// second key is compared, and none from before the last capture or pawn move, as none of those can match
+    /// </summary>
+    /// <param name="key">the position's hash key</param>
+    /// <param name="halfmoveClock">the position's halfmove clock, counting moves since the last capture or pawn move</param>
+    /// <returns>true if the position is a repeat</returns>
+    inline bool isRepetition( unsigned long long key, unsigned short halfmoveClock ) const
+    {
+        const size_t limit = std::min<size_t>( halfmoveClock, keys.size() );
+
+        for ( size_t back = 2; back <= limit; back += 2 )
+        {
+            if ( keys[ keys.size() - back ] == key )
+            {
+                return true;
+            }
+        }
+
+        return false;
+    }
+};
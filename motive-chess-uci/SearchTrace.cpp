@@ -0,0 +1,111 @@
+#include "SearchTrace.h"
+
+#include <fstream>
+#include <iomanip>
+
+#include "Log.h"
+
+void SearchTrace::start( const std::string& filename )
+{
+    SearchTrace::filename = filename;
+    origin = std::chrono::steady_clock::now();
+
+    enabled.store( true, std::memory_order_release );
+}
+
+SearchTrace::Buffer& SearchTrace::getBuffer()
+{
+    thread_local Buffer* buffer = nullptr;
+
+    if ( buffer == nullptr )
+    {
+        std::lock_guard<std::mutex> guard( buffersMutex );
+
+        buffers.push_back( std::make_unique<Buffer>() );
+        buffer = buffers.back().get();
+
+        buffer->threadId = static_cast<unsigned int>( buffers.size() );
+        buffer->threadName = nullptr;
+
+        // Enough for a long search without reallocating part way through
+        buffer->events.reserve( 4096 );
+    }
+
+    return *buffer;
+}
+
+void SearchTrace::record( char phase, const char* name, const char* argumentName, long long argument )
+{
+    long long nanoseconds = std::chrono::duration_cast<std::chrono::nanoseconds>( std::chrono::steady_clock::now() - origin ).count();
+
+    getBuffer().events.push_back( Event { name, argumentName, argument, nanoseconds, phase } );
+}
+
+void SearchTrace::nameThread( const char* name )
+{
+    if ( isEnabled() )
+    {
+        getBuffer().threadName = name;
+    }
+}
+
+void SearchTrace::finish()
+{
+    if ( !enabled.exchange( false, std::memory_order_acquire ) )
+    {
+        return;
+    }
+
+    std::ofstream stream( filename, std::ios::out );
+    if ( !stream.is_open() )
+    {
+        Log::Error << "Unable to write trace to " << filename << std::endl;
+        return;
+    }
+
+    std::lock_guard<std::mutex> guard( buffersMutex );
+
+    size_t count = 0;
+    bool first = true;
+
+    stream << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+
+    for ( const std::unique_ptr<Buffer>& buffer : buffers )
+    {
+        if ( buffer->threadName != nullptr )
+        {
+            stream << ( first ? "\n" : ",\n" )
+                   << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << buffer->threadId
+                   << ",\"args\":{\"name\":\"" << buffer->threadName << "\"}}";
+            first = false;
+        }
+
+        for ( const Event& event : buffer->events )
+        {
+            // Microseconds, to the nanosecond
+            stream << ( first ? "\n" : ",\n" )
+                   << "{\"name\":\"" << event.name << "\",\"ph\":\"" << event.phase << "\",\"pid\":1,\"tid\":" << buffer->threadId
+                   << ",\"ts\":" << event.nanoseconds / 1000 << "." << std::setfill( '0' ) << std::setw( 3 ) << event.nanoseconds % 1000;
+
+            if ( event.phase == 'i' )
+            {
+                // Mark the thread's track rather than drawing a line across all of them
+                stream << ",\"s\":\"t\"";
+            }
+
+            if ( event.argumentName != nullptr )
+            {
+                stream << ",\"args\":{\"" << event.argumentName << "\":" << event.argument << "}";
+            }
+
+            stream << "}";
+            first = false;
+        }
+
+        count += buffer->events.size();
+    }
+
+    stream << "\n]}\n";
+
+    Log::Info << "Wrote " << count << " trace events to " << filename << std::endl;
+}
@@ -0,0 +1,116 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/// <summary>
+/// Records timestamped events from the UCI and search threads - commands, iterations, waits and the best move - and
+/// writes them out in Chrome's trace event format, to be opened with chrome://tracing or Perfetto, to see where the
+/// time for a move went. Each thread appends to its own buffer, so recording takes no lock, and while tracing is off
+/// every call is a single flag test.
+/// Event names must be string literals, or otherwise outlive the trace, as only the pointer is kept
+/// </summary>
+class SearchTrace
+{
+private:
+    class Event
+    {
+    public:
+        const char* name;
+        const char* argumentName;
+        long long argument;
+        long long nanoseconds;
+        char phase;
+    };
+
+    class Buffer
+    {
+    public:
+        unsigned int threadId;
+        const char* threadName;
+        std::vector<Event> events;
+    };
+
+    inline static std::atomic<bool> enabled = false;
+    inline static std::string filename;
+    inline static std::chrono::steady_clock::time_point origin;
+
+    // Buffers outlive their threads, as the search threads are gone by the time the trace is written
+    inline static std::mutex buffersMutex;
+    inline static std::vector<std::unique_ptr<Buffer>> buffers;
+
+    static Buffer& getBuffer();
+
+    static void record( char phase, const char* name, const char* argumentName, long long argument );
+
+public:
+    /// <summary>
+    /// Start recording, for writing to a file at shutdown
+    /// </summary>
+    /// <param name="filename">where to write the trace</param>
+    static void start( const std::string& filename );
+
+    /// <summary>
+    /// Stop recording and write out everything recorded. Only safe once every traced thread has finished
+    /// </summary>
+    static void finish();
+
+    inline static bool isEnabled()
+    {
+        return enabled.load( std::memory_order_relaxed );
+    }
+
+    /// <summary>
+    /// Label the calling thread's events in the trace
+    /// </summary>
+    static void nameThread( const char* name );
+
+    inline static void begin( const char* name, const char* argumentName = nullptr, long long argument = 0 )
+    {
+        if ( isEnabled() )
+        {
+            record( 'B', name, argumentName, argument );
+        }
+    }
+
+    inline static void end( const char* name )
+    {
+        if ( isEnabled() )
+        {
+            record( 'E', name, nullptr, 0 );
+        }
+    }
+
+    inline static void instant( const char* name, const char* argumentName = nullptr, long long argument = 0 )
+    {
+        if ( isEnabled() )
+        {
+            record( 'i', name, argumentName, argument );
+        }
+    }
+
+    /// <summary>
+    /// Begins an event on construction and ends it on destruction
+    /// </summary>
+    class Scope
+    {
+    private:
+        const char* name;
+
+    public:
+        Scope( const char* name, const char* argumentName = nullptr, long long argument = 0 ) :
+            name( name )
+        {
+            SearchTrace::begin( name, argumentName, argument );
+        }
+
+        virtual ~Scope()
+        {
+            SearchTrace::end( name );
+        }
+    };
+};
@@ -86,6 +86,11 @@ public:
         logStream = logFile;
     }
 
+    bool isInputFile() const
+    {
+        return inputFile != nullptr;
+    }
+
     std::ostream& getOuputStream() const
     {
         return *outputStream;
@@ -2,9 +2,11 @@
 
 #include <array>
 #include <bitset>
+#include <charconv>
 #include <source_location>
 #include <sstream>
 #include <string>
+#include <string_view>
 
 /// <summary>
 /// Static utility methods for mapping and suchlike
@@ -29,6 +31,19 @@ private:
     static std::string lowerSquareNames[ 64 ];
 
 public:
+    /// <summary>
+    /// Read a whole number from text without allocating, as for UCI command arguments
+    /// </summary>
+    /// <param name="text">the text</param>
+    /// <returns>the number, or zero if the text doesn't start with one</returns>
+    inline static int toInt( std::string_view text )
+    {
+        int value = 0;
+        std::from_chars( text.data(), text.data() + text.length(), value );
+
+        return value;
+    }
+
     inline static unsigned short squareToIndex( const std::string& square )
     {
         if ( square.empty() )
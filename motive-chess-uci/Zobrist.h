@@ -0,0 +1,100 @@
+#pragma once
+
+#include "CastlingRights.h"
+#include "Utilities.h"
+
+/// <summary>
+/// Random keys for building position hashes incrementally.
+/// Piece keys are indexed by the full piece byte (color and type, see Piece) and square index,
+/// so a key can be toggled in or out with a single XOR as pieces are placed and removed
+/// </summary>
+class Zobrist
+{
+private:
+    class Keys
+    {
+    public:
+        // Largest piece byte is BKING (0b00010110), so this covers every colored piece
+        unsigned long long pieceKeys[ 24 ][ 64 ];
+        unsigned long long castlingKeys[ 16 ];
+        unsigned long long enPassantKeys[ 8 ];
+        unsigned long long blackToMoveKey;
+    };
+
+    // Generated at compile time, so the keys are in read-only data and usable from static initializers
+    static const Keys keys;
+
+    static constexpr Keys buildKeys()
+    {
+        Keys keys{};
+
+        // Use a fixed seed so that hashes (and therefore anything keyed by them) are the same from run to run
+        // https://prng.di.unimi.it/splitmix64.c
+        unsigned long long seed = 0x4D6F746976654368ull;
+
+        auto next = [&] ()
+        {
+            unsigned long long z = ( seed += 0x9E3779B97F4A7C15ull );
+            z = ( z ^ ( z >> 30 ) ) * 0xBF58476D1CE4E5B9ull;
+            z = ( z ^ ( z >> 27 ) ) * 0x94D049BB133111EBull;
+
+            return z ^ ( z >> 31 );
+        };
+
+        for ( unsigned short piece = 0; piece < 24; piece++ )
+        {
+            for ( unsigned short index = 0; index < 64; index++ )
+            {
+                keys.pieceKeys[ piece ][ index ] = next();
+            }
+        }
+
+        // No castling rights contributes nothing, so a position without them hashes the same however it got there
+        keys.castlingKeys[ 0 ] = 0;
+        for ( unsigned short rights = 1; rights < 16; rights++ )
+        {
+            keys.castlingKeys[ rights ] = next();
+        }
+
+        for ( unsigned short file = 0; file < 8; file++ )
+        {
+            keys.enPassantKeys[ file ] = next();
+        }
+
+        keys.blackToMoveKey = next();
+
+        // The empty square never contributes to a hash
+        for ( unsigned short index = 0; index < 64; index++ )
+        {
+            keys.pieceKeys[ 0 ][ index ] = 0;
+        }
+
+        return keys;
+    }
+
+public:
+    inline static unsigned long long getPieceKey( unsigned char piece, unsigned short index )
+    {
+        return keys.pieceKeys[ piece ][ index ];
+    }
+
+    inline static unsigned long long getCastlingKey( const CastlingRights& castlingRights )
+    {
+        return keys.castlingKeys[ castlingRights.getRights() ];
+    }
+
+    /// <summary>
+    /// The en passant key depends only on the file, and is zero if there is no en passant square
+    /// </summary>
+    inline static unsigned long long getEnPassantKey( unsigned short enPassantIndex )
+    {
+        return Utilities::isOffboard( enPassantIndex ) ? 0 : keys.enPassantKeys[ Utilities::indexToFile( enPassantIndex ) ];
+    }
+
+    inline static unsigned long long getBlackToMoveKey()
+    {
+        return keys.blackToMoveKey;
+    }
+};
+
+inline constexpr Zobrist::Keys Zobrist::keys = Zobrist::buildKeys();
@@ -2,32 +2,59 @@
 //
 
 #include <algorithm>
+#include <cctype>
 #include <iostream>
 #include <fstream>
-#include <sstream>
 #include <string>
+#include <string_view>
 #include <vector>
 
+#include "AsyncLogDestination.h"
 #include "Engine.h"
 #include "Log.h"
+#include "SearchTrace.h"
 #include "Streams.h"
 #include "VersionInfo.h"
 
-std::vector<std::string> getUciCommands();
-void logSanitizedInput( std::vector<std::string> input );
-bool processCommandLine( int argc, char** argv, Streams& streams );
-bool processUciCommand( Engine& engine, std::vector<std::string> input );
+enum class UciCommand
+{
+    UCI,
+    DEBUG,
+    ISREADY,
+    SETOPTION,
+    REGISTER,
+    UCINEWGAME,
+    POSITION,
+    GO,
+    STOP,
+    PONDERHIT,
+    QUIT,
+    PERFT,
+    BENCH,
+    UNKNOWN
+};
+
+UciCommand toUciCommand( std::string_view word );
+void tokenize( std::string_view line, std::vector<std::string_view>& tokens );
+bool processCommandLine( int argc, char** argv, Streams& streams, std::vector<std::string>& commands );
+bool processUciCommand( Engine& engine, UciCommand command, std::vector<std::string_view>& arguments );
 
 int main( int argc, char** argv )
 {
     Streams streams;
 
+    // Commands given on the command line, run before any input is read
+    std::vector<std::string> commands;
+
+    // Nonzero if a test run found a problem, for scripts to pick up
+    int exitCode = 0;
+
     // Default logging setup - can be modified later
 
     Log::setDestination( new ConsoleLogDestination() );
 
     // Allow command line processing to cause an exit without further activity
-    if ( processCommandLine( argc, argv, streams ) )
+    if ( processCommandLine( argc, argv, streams, commands ) )
     {
         Log::Debug( "Starting" );
 
@@ -35,57 +62,81 @@ int main( int argc, char** argv )
         Broadcaster broadcaster( streams.getOuputStream() );
         Engine engine( broadcaster );
 
-        // Initialize list of UCI commands
-        std::vector<std::string> uci = getUciCommands();
-
-        std::vector<std::string> input;
+        // The line and its tokens are reused from one line to the next, and the tokens are views into the line,
+        // so once their capacity has grown to fit the longest line seen, reading a command allocates nothing
+        std::vector<std::string_view> input;
+        std::vector<std::string_view> arguments;
         std::string line;
-        while ( streams.getLine( line ) )
+        size_t nextCommand = 0;
+        while ( true )
         {
-            input.clear();
-
-            Log::Trace << "Raw input: [" << line << "]" << std::endl;
-
-            // Tokenize the input into a list of strings
-            std::replace( line.begin(), line.end(), '\n', ' ' );
-            std::replace( line.begin(), line.end(), '\t', ' ' );
-            std::stringstream stream( line );
-            std::string token;
-            while ( std::getline( stream, token, ' ' ) )
+            bool queued = nextCommand < commands.size();
+            if ( queued )
             {
-                if ( token.length() > 0 )
-                {
-                    input.push_back( token );
-                }
+                line = commands[ nextCommand++ ];
+            }
+            else if ( !streams.getLine( line ) )
+            {
+                break;
             }
 
-            // Prune unrecognized commands from start of input
-            if ( input.size() )
+            Log::Trace( [&] ( const Log::Logger& logger )
+            {
+                logger << "Raw input: [" << line << "]" << std::endl;
+            } );
+
+            tokenize( line, input );
+
+            // Skip unrecognized words at the start of the input, as the UCI protocol requires
+            UciCommand command = UciCommand::UNKNOWN;
+            std::vector<std::string_view>::const_iterator it = input.cbegin();
+            for ( ; it != input.cend(); it++ )
             {
-                while ( std::find( uci.begin(), uci.end(), *input.begin() ) == uci.end() )
+                command = toUciCommand( *it );
+                if ( command != UciCommand::UNKNOWN )
                 {
-                    input.erase( input.begin() );
-                    if ( input.size() == 0 )
-                    {
-                        break;
-                    }
+                    break;
                 }
             }
 
             // If nothing left, loop around
-            if ( input.size() == 0 )
+            if ( command == UciCommand::UNKNOWN )
             {
                 continue;
             }
 
             // Dump the sanitized input
-            logSanitizedInput( input );
+            Log::Trace( [&] ( const Log::Logger& logger )
+            {
+                logger << "Cleaned input: [";
+                for ( std::vector<std::string_view>::const_iterator word = it; word != input.cend(); word++ )
+                {
+                    logger << ( word == it ? "" : " " ) << *word;
+                }
+                logger << "]" << std::endl;
+            } );
+
+            arguments.assign( it + 1, input.cend() );
 
             // Process command input until told to quit
-            if ( !processUciCommand( engine, input ) )
+            if ( !processUciCommand( engine, command, arguments ) )
             {
                 break;
             }
+
+            // Scripted commands run one after another, as they always have - only interactive input can stop a perft
+            if ( queued || streams.isInputFile() )
+            {
+                engine.waitForPerft();
+            }
+        }
+
+        // Let a perft started before the input ran out finish, as its result is still wanted
+        engine.waitForPerft();
+
+        if ( engine.hasPerftFailed() )
+        {
+            exitCode = 1;
         }
 
         Log::Debug << "Closing" << std::endl;
@@ -95,57 +146,78 @@ int main( int argc, char** argv )
         Log::Debug << "Closing after command line processing" << std::endl;
     }
 
+    // Everything traced has finished by now, the engine and its threads having gone
+    SearchTrace::finish();
+
     Log::shutdown();
 
-    return 0;
+    return exitCode;
 }
 
-void logSanitizedInput( std::vector<std::string> input )
+void tokenize( std::string_view line, std::vector<std::string_view>& tokens )
 {
-    std::ostringstream sanitized;
+    tokens.clear();
 
-    bool first = true;
-    for ( std::vector<std::string>::iterator it = input.begin(); it != input.end(); it++ )
+    size_t start = 0;
+    while ( start < line.length() )
     {
-        if ( first )
+        size_t end = line.find_first_of( " \t\r\n", start );
+        if ( end == std::string_view::npos )
         {
-            first = false;
+            end = line.length();
         }
-        else
+
+        if ( end > start )
         {
-            sanitized << " ";
+            tokens.push_back( line.substr( start, end - start ) );
         }
 
-        sanitized << *it;
+        start = end + 1;
     }
-
-    Log::Trace << "Cleaned input: [" << sanitized.str() << "]" << std::endl;
 }
 
-std::vector<std::string> getUciCommands()
+UciCommand toUciCommand( std::string_view word )
 {
-    std::vector<std::string> uci;
-
-    // From 2006 version of UCI spec from ShredderChess site
-    uci.push_back( "uci" );
-    uci.push_back( "debug" );
-    uci.push_back( "isready" );
-    uci.push_back( "setoption" );
-    uci.push_back( "register" );
-    uci.push_back( "ucinewgame" );
-    uci.push_back( "position" );
-    uci.push_back( "go" );
-    uci.push_back( "stop" );
-    uci.push_back( "ponderhit" );
-    uci.push_back( "quit" );
-
-    // Special testing command - perft
-    uci.push_back( "perft" );
-
-    return uci;
+    // Switch on the first letter so that most words are settled with a single comparison
+    switch ( word.empty() ? '\0' : word[ 0 ] )
+    {
+        case 'b':
+            return word == "bench" ? UciCommand::BENCH : UciCommand::UNKNOWN; // Special testing command - bench
+
+        case 'd':
+            return word == "debug" ? UciCommand::DEBUG : UciCommand::UNKNOWN;
+
+        case 'g':
+            return word == "go" ? UciCommand::GO : UciCommand::UNKNOWN;
+
+        case 'i':
+            return word == "isready" ? UciCommand::ISREADY : UciCommand::UNKNOWN;
+
+        case 'p':
+            return word == "position" ? UciCommand::POSITION :
+                   word == "ponderhit" ? UciCommand::PONDERHIT :
+                   word == "perft" ? UciCommand::PERFT : UciCommand::UNKNOWN; // Special testing command - perft
+
+        case 'q':
+            return word == "quit" ? UciCommand::QUIT : UciCommand::UNKNOWN;
+
+        case 'r':
+            return word == "register" ? UciCommand::REGISTER : UciCommand::UNKNOWN;
+
+        case 's':
+            return word == "setoption" ? UciCommand::SETOPTION :
+                   word == "stop" ? UciCommand::STOP : UciCommand::UNKNOWN;
+
+        case 'u':
+            return word == "uci" ? UciCommand::UCI :
+                   word == "ucinewgame" ? UciCommand::UCINEWGAME : UciCommand::UNKNOWN;
+
+        default:
+            return UciCommand::UNKNOWN;
+    }
 }
 
-bool processCommandLine( int argc, char** argv, Streams& streams )
+bool processCommandLine( int argc, char** argv, Streams& streams, std::vector<std::string>& commands )
 {
     // Set initial defaults
     
@@ -213,6 +285,36 @@ bool processCommandLine( int argc, char** argv, Streams& streams )
         }
     }
 
+    it = std::find( arguments.begin(), arguments.end(), "-async" );
+    if ( it != arguments.end() && std::find( arguments.begin(), arguments.end(), "-silent" ) == arguments.end() )
+    {
+        // Optionally followed by what to do when logging outpaces writing, dropping messages by default
+        AsyncLogDestination::Overflow overflow = AsyncLogDestination::Overflow::DROP;
+
+        ++it;
+        if ( it != arguments.end() && *it == "block" )
+        {
+            overflow = AsyncLogDestination::Overflow::BLOCK;
+        }
+
+        // Hand over the destination chosen above, without deleting it
+        Log::Destination* target = Log::getDestination();
+        Log::releaseDestination();
+        Log::setDestination( new AsyncLogDestination( target, overflow ) );
+    }
+
+    it = std::find( arguments.begin(), arguments.end(), "-trace" );
+    if ( it != arguments.end() )
+    {
+        // Take the next argument as a filename
+        ++it;
+        if ( it != arguments.end() )
+        {
+            SearchTrace::start( *it );
+            SearchTrace::nameThread( "uci" );
+        }
+    }
+
     // Complete logging setup now we have determined its configuration
 
     Log::getDestination()->setLevel( logLevel );
@@ -264,15 +366,48 @@ bool processCommandLine( int argc, char** argv, Streams& streams )
         std::cout << "  -debug   - detailed logging" << std::endl;
         std::cout << "  -verbose - trace logging" << std::endl;
         std::cout << std::endl << "Debug options:" << std::endl;
+        std::cout << "  -bench [depth]  - search the benchmark positions, report nodes and speed, and exit" << std::endl;
+        std::cout << "  -perftsuite <file> - run every perft count in an EPD file across all cores, and exit, nonzero on a mismatch" << std::endl;
         std::cout << "  -input <file>   - read input from file rather than stdin" << std::endl;
         std::cout << "  -output <file>  - write output to file rather than stdout" << std::endl;
         std::cout << "  -logfile <file> - write logging to file rather than stderr" << std::endl;
         std::cout << "  -tee <file> - write logging to file and stderr" << std::endl;
+        std::cout << "  -trace <file>   - record search events to file, in Chrome trace format, for chrome://tracing or Perfetto" << std::endl;
+        std::cout << "  -async [drop|block] - write logging from a background thread, dropping (default) or" << std::endl;
+        std::cout << "                        waiting when it falls behind" << std::endl;
         std::cout << std::endl;
 
         return false;
     }
 
+    it = std::find( arguments.begin(), arguments.end(), "-bench" );
+    if ( it != arguments.end() )
+    {
+        // Run the bench command, to an optional depth, and exit
+        std::string command = "bench";
+
+        ++it;
+        if ( it != arguments.end() && !it->empty() && std::isdigit( static_cast<unsigned char>( ( *it )[ 0 ] ) ) )
+        {
+            command += " " + *it;
+        }
+
+        commands.push_back( command );
+        commands.push_back( "quit" );
+    }
+
+    it = std::find( arguments.begin(), arguments.end(), "-perftsuite" );
+    if ( it != arguments.end() )
+    {
+        // Take the next argument as a filename, run every count in it, and exit
+        ++it;
+        if ( it != arguments.end() )
+        {
+            commands.push_back( "perft suite " + *it );
+            commands.push_back( "quit" );
+        }
+    }
+
     it = std::find( arguments.begin(), arguments.end(), "-version" );
     if ( it != arguments.end() )
     {
@@ -293,67 +428,74 @@ bool processCommandLine( int argc, char** argv, Streams& streams )
     return true;
 }
 
-bool processUciCommand( Engine& engine, std::vector<std::string> input )
+bool processUciCommand( Engine& engine, UciCommand command, std::vector<std::string_view>& arguments )
 {
     bool quit = false;
 
-    // Pop the command (first item) and leave the rest
-    std::string command = input[ 0 ];
-    input.erase( input.begin() );
+    switch ( command )
+    {
+        case UciCommand::UCI:
+            engine.uciCommand();
+            break;
 
-    Log::Trace << "Processing " << command << std::endl;
+        case UciCommand::DEBUG:
+            engine.debugCommand( arguments );
+            break;
 
-    if ( command == "uci" )
-    {
-        engine.uciCommand();
-    }
-    else if ( command == "debug" )
-    {
-        engine.debugCommand( input );
-    }
-    else if ( command == "isready" )
-    {
-        engine.isreadyCommand();
-    }
-    else if ( command == "setoption" )
-    {
-        engine.setoptionCommand( input );
-    }
-    else if ( command == "register" )
-    {
-        engine.registerCommand( input );
-    }
-    else if ( command == "ucinewgame" )
-    {
-        engine.ucinewgameCommand();
-    }
-    else if ( command == "position" )
-    {
-        engine.positionCommand( input );
-    }
-    else if ( command == "go" )
-    {
-        engine.goCommand( input );
-    }
-    else if ( command == "stop" )
-    {
-        engine.stopCommand();
-    }
-    else if ( command == "ponderhit" )
-    {
-        engine.ponderhitCommand();
-    }
-    else if ( command == "quit" )
-    {
-        quit = engine.quitCommand();
-    }
-    // Special perft command
-    else if ( command == "perft" )
-    {
-        engine.perftCommand( input );
+        case UciCommand::ISREADY:
+            engine.isreadyCommand();
+            break;
+
+        case UciCommand::SETOPTION:
+            engine.setoptionCommand( arguments );
+            break;
+
+        case UciCommand::REGISTER:
+            engine.registerCommand( arguments );
+            break;
+
+        case UciCommand::UCINEWGAME:
+            engine.ucinewgameCommand();
+            break;
+
+        case UciCommand::POSITION:
+            engine.positionCommand( arguments );
+            break;
+
+        case UciCommand::GO:
+            engine.goCommand( arguments );
+            break;
+
+        case UciCommand::STOP:
+            engine.stopCommand();
+            break;
+
+        case UciCommand::PONDERHIT:
+            engine.ponderhitCommand();
+            break;
+
+        case UciCommand::QUIT:
+            quit = engine.quitCommand();
+            break;
+
+        // Special perft command, which edits its arguments as it parses them
+        case UciCommand::PERFT:
+        {
+            std::vector<std::string> perftArguments( arguments.begin(), arguments.end() );
+            engine.perftCommand( perftArguments );
+            break;
+        }
+
+        // Special bench command
+        case UciCommand::BENCH:
+            engine.benchCommand( arguments );
+            break;
+
+        default:
+            break;
     }
 
     Log::Trace << "Quit state is " << quit << std::endl;
 
     return !quit;
-}
\ No newline at end of file
+}